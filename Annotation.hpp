@@ -18,6 +18,7 @@
 #ifndef CHIC_ANNOTATION_HPP
 #define CHIC_ANNOTATION_HPP
 
+#include <string>
 #include <type_traits>
 
 namespace Chic {
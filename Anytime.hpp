@@ -0,0 +1,217 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_ANYTIME_HPP
+#define CHIC_ANYTIME_HPP
+
+#include "Dictionary.hpp"
+#include "Step.hpp"
+#include <chrono>
+#include <unordered_map>
+
+namespace Chic {
+
+// An upper bound on the digits to make a target, found by decomposing it as
+// T = p or T = p +- c, where p is a * b, a ^ b or a! / b! and a, b, c are
+// keys already in a dictionary.  The search tries pairs of operands in
+// increasing digits of the first one and stops after `budget` pairs.
+template<typename Key>
+class Bound
+{
+  private:
+    Key _target;
+    Key _middle;
+    Step<Key> _outer;
+    Step<Key> _inner;
+    std::size_t _digits;
+
+    void _offer(Key, Step<Key>, std::size_t, const std::unordered_map<Key, std::size_t>&);
+
+  public:
+    explicit Bound(Key);
+
+    std::size_t digits() const;
+    explicit operator bool() const;
+
+    template<typename Monitor>
+    void search(const Dictionary<Key, Monitor>&, std::size_t budget = -1);
+
+    template<typename Monitor, typename Function>
+    Function bfs(const Dictionary<Key, Monitor>&, Function) const;
+};
+
+template<typename Key>
+Bound<Key>::Bound(Key target)
+  : _target(target),
+    _digits(-1)
+{}
+
+template<typename Key>
+std::size_t Bound<Key>::digits() const
+{
+  return _digits;
+}
+
+template<typename Key>
+Bound<Key>::operator bool() const
+{
+  return _digits != std::size_t(-1);
+}
+
+template<typename Key>
+void Bound<Key>::_offer(Key middle, Step<Key> inner, std::size_t digits, const std::unordered_map<Key, std::size_t>& index)
+{
+  if (!std::isnormal(middle) || digits >= _digits)
+    return;
+
+  if (middle == _target) {
+    _middle = middle;
+    _outer = Step<Key>();
+    _inner = inner;
+    _digits = digits;
+    return;
+  }
+
+  Key sum = _target - middle;
+  Key difference = middle - _target;
+  auto found = index.find(sum);
+
+  if (std::isnormal(sum) && found != index.end() && digits + found->second < _digits) {
+    _middle = middle;
+    _outer = { middle, sum, '+' };
+    _inner = inner;
+    _digits = digits + found->second;
+  }
+
+  found = index.find(difference);
+
+  if (std::isnormal(difference) && found != index.end() && digits + found->second < _digits) {
+    _middle = middle;
+    _outer = { middle, difference, '-' };
+    _inner = inner;
+    _digits = digits + found->second;
+  }
+}
+
+template<typename Key>
+template<typename Monitor>
+void Bound<Key>::search(const Dictionary<Key, Monitor>& dictionary, std::size_t budget)
+{
+  std::unordered_map<Key, std::size_t> index;
+  std::vector<std::pair<Key, std::size_t>> keys;
+
+  for (std::size_t level = 0; level < dictionary.level(); ++level) {
+    for (Key key: dictionary[level]) {
+      index.emplace(key, level + 1);
+      keys.emplace_back(key, level + 1);
+    }
+  }
+
+  auto found = index.find(_target);
+
+  if (found != index.end() && found->second < _digits) {
+    _middle = _target;
+    _outer = Step<Key>();
+    _inner = Step<Key>();
+    _digits = found->second;
+  }
+
+  for (std::size_t i = 0; i < keys.size() && budget; ++i) {
+    Key a = keys[i].first;
+
+    for (std::size_t j = 0; j < keys.size() && budget; ++j, --budget) {
+      Key b = keys[j].first;
+      std::size_t digits = keys[i].second + keys[j].second;
+
+      if (digits >= _digits)
+        break;
+
+      _offer(a * b, { a, b, '*' }, digits, index);
+
+      if (!(a == Key(1)))
+        _offer(a.pow(b), { a, b, {'^', 0} }, digits, index);
+
+      if (!(a == b || (std::isnormal(a.factorial()) && std::isnormal(b.factorial()))))
+        _offer(a.factorial(b), { a, b, {'!', '/'} }, digits, index);
+    }
+  }
+}
+
+template<typename Key>
+template<typename Monitor, typename Function>
+Function Bound<Key>::bfs(const Dictionary<Key, Monitor>& dictionary, Function f) const
+{
+  if (!_inner)
+    return dictionary.bfs(_middle, f);
+
+  if (_outer)
+    f(_target, _outer);
+
+  f(_middle, _inner);
+
+  if (_outer)
+    return dictionary.bfs(_outer.second(), dictionary.bfs(_inner.second(), dictionary.bfs(_inner.first(), f)));
+
+  return dictionary.bfs(_inner.second(), dictionary.bfs(_inner.first(), f));
+}
+
+// Grow a dictionary toward a target until it is found, the levels below
+// `limit` are exhausted, the deadline has passed, or the next level would
+// exceed the memory cap or is not expected to finish before the deadline.
+// The first level of a call is timed by Dictionary::estimate(), and later
+// ones by scaling the duration of the previous level by its predicted growth.
+// Return whether the search is conclusive.
+template<typename Key, typename Monitor>
+bool refine(Dictionary<Key, Monitor>& dictionary, Key target, std::size_t limit, std::chrono::steady_clock::time_point deadline)
+{
+  typedef std::chrono::steady_clock Clock;
+
+  Clock::duration last = Clock::duration::zero();
+
+  while (!dictionary.digits(target)) {
+    std::size_t size = dictionary.level();
+
+    if (size + 1 >= limit)
+      return true;
+
+    Clock::time_point start = Clock::now();
+
+    if (start >= deadline)
+      return false;
+
+    double ratio = size ? double(dictionary.predict()) / dictionary[size - 1].size() : 1;
+    Clock::duration next = last == Clock::duration::zero()
+      ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(dictionary.estimate().seconds))
+      : std::chrono::duration_cast<Clock::duration>(last * ratio);
+
+    if (start + next > deadline)
+      return false;
+
+    dictionary.build(target, size + 1);
+
+    if (dictionary.full())
+      return false;
+
+    last = Clock::now() - start;
+  }
+
+  return true;
+}
+
+} // namespace Chic
+
+#endif // CHIC_ANYTIME_HPP
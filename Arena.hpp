@@ -0,0 +1,282 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_ARENA_HPP
+#define CHIC_ARENA_HPP
+
+#include <memory>
+#include <new>
+#include <vector>
+#include <cstdint>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace Chic {
+
+// Storage of Dictionary carved from large chunks mapped with huge pages, or
+// advised to use transparent huge pages if none are reserved.  Chunks grow
+// geometrically and are only unmapped all at once, when the last container
+// using them is gone.
+//
+// The arena only reuses memory freed in stack order: deallocation rewinds the
+// most recent block and ignores any other.  Memory freed by rehashing and
+// reallocation is mostly kept, so the mapped size can reach about twice what
+// the containers use.  Dictionary::bytes() charges the mapped size for this.
+class Arena
+{
+  public:
+    static const std::size_t page = std::size_t(1) << 21;
+
+    template<typename T>
+    class Allocator;
+
+  private:
+    struct Chunk
+    {
+      char* data;
+      std::size_t size;
+      bool huge;
+    };
+
+    struct Pool
+    {
+      std::vector<Chunk> chunks;
+      char* top;
+      char* end;
+      std::uint_fast64_t allocations;
+
+      Pool();
+      ~Pool();
+
+      Pool(const Pool&) = delete;
+      Pool& operator=(const Pool&) = delete;
+
+      void* allocate(std::size_t, std::size_t);
+      void deallocate(void*, std::size_t);
+      void map(std::size_t);
+    };
+
+    std::shared_ptr<Pool> _pool;
+
+  public:
+    Arena();
+
+    template<typename T>
+    Allocator<T> allocator() const;
+
+    std::uint_fast64_t allocations() const;
+    std::size_t chunks() const;
+    std::size_t huge() const;
+    std::size_t bytes() const;
+};
+
+template<typename T>
+class Arena::Allocator
+{
+  private:
+    std::shared_ptr<Pool> _pool;
+
+    template<typename> friend class Allocator;
+
+  public:
+    typedef T value_type;
+
+    explicit Allocator(std::shared_ptr<Pool>);
+
+    template<typename U>
+    Allocator(const Allocator<U>&);
+
+    T* allocate(std::size_t);
+    void deallocate(T*, std::size_t);
+
+    template<typename U>
+    bool operator==(const Allocator<U>&) const;
+
+    template<typename U>
+    bool operator!=(const Allocator<U>&) const;
+};
+
+inline
+Arena::Pool::Pool()
+  : top(nullptr),
+    end(nullptr),
+    allocations(0)
+{}
+
+inline
+Arena::Pool::~Pool()
+{
+  for (const Chunk& chunk: chunks) {
+#ifdef __linux__
+    munmap(chunk.data, chunk.size);
+#else
+    ::operator delete(chunk.data);
+#endif
+  }
+}
+
+// Map a chunk of at least `bytes` bytes, twice as large as the last one
+inline
+void Arena::Pool::map(std::size_t bytes)
+{
+  std::size_t size = chunks.empty() ? page : 2 * chunks.back().size;
+
+  while (size < bytes)
+    size *= 2;
+
+  Chunk chunk = { nullptr, size, false };
+
+#ifdef __linux__
+  void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+  chunk.huge = data != MAP_FAILED;
+
+  if (!chunk.huge) {
+    data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (data == MAP_FAILED)
+      throw std::bad_alloc();
+
+#ifdef MADV_HUGEPAGE
+    madvise(data, size, MADV_HUGEPAGE);
+#endif
+  }
+
+  chunk.data = static_cast<char*>(data);
+#else
+  chunk.data = static_cast<char*>(::operator new(size));
+#endif
+
+  chunks.push_back(chunk);
+  top = chunk.data;
+  end = chunk.data + size;
+}
+
+inline
+void* Arena::Pool::allocate(std::size_t bytes, std::size_t alignment)
+{
+  std::uintptr_t address = (reinterpret_cast<std::uintptr_t>(top) + alignment - 1) & -alignment;
+
+  if (!top || address + bytes > reinterpret_cast<std::uintptr_t>(end)) {
+    map(bytes + alignment);
+    address = (reinterpret_cast<std::uintptr_t>(top) + alignment - 1) & -alignment;
+  }
+
+  top = reinterpret_cast<char*>(address + bytes);
+  ++allocations;
+
+  return reinterpret_cast<void*>(address);
+}
+
+inline
+void Arena::Pool::deallocate(void* data, std::size_t bytes)
+{
+  if (static_cast<char*>(data) + bytes == top)
+    top = static_cast<char*>(data);
+}
+
+inline
+Arena::Arena()
+  : _pool(std::make_shared<Pool>())
+{}
+
+template<typename T>
+Arena::Allocator<T> Arena::allocator() const
+{
+  return Allocator<T>(_pool);
+}
+
+// Calls to allocate, each of which would otherwise go to the heap
+inline
+std::uint_fast64_t Arena::allocations() const
+{
+  return _pool->allocations;
+}
+
+// Calls to mmap
+inline
+std::size_t Arena::chunks() const
+{
+  return _pool->chunks.size();
+}
+
+// Chunks backed by reserved huge pages rather than advice
+inline
+std::size_t Arena::huge() const
+{
+  std::size_t count = 0;
+
+  for (const Chunk& chunk: _pool->chunks)
+    count += chunk.huge;
+
+  return count;
+}
+
+// Bytes mapped, including those freed out of stack order
+inline
+std::size_t Arena::bytes() const
+{
+  std::size_t bytes = 0;
+
+  for (const Chunk& chunk: _pool->chunks)
+    bytes += chunk.size;
+
+  return bytes;
+}
+
+template<typename T>
+Arena::Allocator<T>::Allocator(std::shared_ptr<Pool> pool)
+  : _pool(std::move(pool))
+{}
+
+template<typename T>
+template<typename U>
+Arena::Allocator<T>::Allocator(const Allocator<U>& other)
+  : _pool(other._pool)
+{}
+
+template<typename T>
+T* Arena::Allocator<T>::allocate(std::size_t count)
+{
+  return static_cast<T*>(_pool->allocate(count * sizeof(T), alignof(T)));
+}
+
+template<typename T>
+void Arena::Allocator<T>::deallocate(T* data, std::size_t count)
+{
+  _pool->deallocate(data, count * sizeof(T));
+}
+
+template<typename T>
+template<typename U>
+bool Arena::Allocator<T>::operator==(const Allocator<U>& other) const
+{
+  return _pool == other._pool;
+}
+
+template<typename T>
+template<typename U>
+bool Arena::Allocator<T>::operator!=(const Allocator<U>& other) const
+{
+  return _pool != other._pool;
+}
+
+} // namespace Chic
+
+#endif // CHIC_ARENA_HPP
@@ -0,0 +1,126 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_ASYNC_HPP
+#define CHIC_ASYNC_HPP
+
+#include "Dictionary.hpp"
+#include <atomic>
+#include <future>
+#include <memory>
+
+namespace Chic {
+
+// Shared flag to stop a build from another thread.  Copies refer to the
+// same flag.
+class Cancellation
+{
+  private:
+    std::shared_ptr<std::atomic<bool>> _flag;
+
+  public:
+    Cancellation();
+
+    void cancel();
+    bool cancelled() const;
+};
+
+enum class Status { running, found, exhausted, full, cancelled };
+
+// Resumable Dictionary::build for event loops.  Each call to step() does a
+// bounded amount of work and tells whether the build is over.
+template<typename Key, typename Monitor = Silent>
+class Task
+{
+  private:
+    Dictionary<Key, Monitor>& _dictionary;
+    Key _target;
+    std::size_t _limit;
+    Cancellation _cancellation;
+
+  public:
+    Task(Dictionary<Key, Monitor>&, Key, std::size_t limit = -1, Cancellation = Cancellation());
+
+    Status step(std::size_t budget);
+};
+
+inline
+Cancellation::Cancellation()
+  : _flag(std::make_shared<std::atomic<bool>>(false))
+{}
+
+inline
+void Cancellation::cancel()
+{
+  *_flag = true;
+}
+
+inline
+bool Cancellation::cancelled() const
+{
+  return *_flag;
+}
+
+template<typename Key, typename Monitor>
+Task<Key, Monitor>::Task(Dictionary<Key, Monitor>& dictionary, Key target, std::size_t limit, Cancellation cancellation)
+  : _dictionary(dictionary),
+    _target(target),
+    _limit(limit),
+    _cancellation(cancellation)
+{}
+
+template<typename Key, typename Monitor>
+Status Task<Key, Monitor>::step(std::size_t budget)
+{
+  if (_cancellation.cancelled())
+    return Status::cancelled;
+
+  if (!_dictionary.growing() && _dictionary.level() >= _limit)
+    return Status::exhausted;
+
+  if (_dictionary.digits(_target))
+    return Status::found;
+
+  if (!_dictionary.growing() && _dictionary.bytes(_dictionary.predict()) > _dictionary.memory())
+    return Status::full;
+
+  _dictionary.grow_some(budget);
+  return Status::running;
+}
+
+// Run a Task on another thread in slices of `slice` pairs.  After each slice
+// progress(level, fraction) is called with the level being grown and the
+// fraction of its pairs processed.  The dictionary must not be used
+// elsewhere until the future is ready.
+template<typename Key, typename Monitor, typename Progress>
+std::future<Status> build_async(Dictionary<Key, Monitor>& dictionary, Key target, std::size_t limit,
+  Cancellation cancellation, Progress progress, std::size_t slice = 1 << 16)
+{
+  return std::async(std::launch::async, [&dictionary, target, limit, cancellation, progress, slice]() mutable {
+    Task<Key, Monitor> task(dictionary, target, limit, cancellation);
+    Status status;
+
+    while ((status = task.step(slice)) == Status::running)
+      progress(dictionary.level(), dictionary.progress());
+
+    return status;
+  });
+}
+
+} // namespace Chic
+
+#endif // CHIC_ASYNC_HPP
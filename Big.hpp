@@ -0,0 +1,260 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_BIG_HPP
+#define CHIC_BIG_HPP
+
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+
+namespace Chic {
+
+// Unsigned integer of arbitrary width, just enough to confirm answers
+class Big
+{
+  private:
+    std::vector<std::uint32_t> _limbs;
+
+    Big& _trim();
+
+  public:
+    Big(std::uint64_t = 0);
+
+    explicit operator bool() const;
+    int compare(const Big&) const;
+
+    Big& operator+=(const Big&);
+    Big& operator-=(const Big&);
+    Big& operator*=(const Big&);
+};
+
+// Positive rational of Bigs, not reduced, as in the exact replay of a
+// breakdown the operands stay few
+class Rational
+{
+  private:
+    Big _num;
+    Big _den;
+
+  public:
+    Rational(Big = 0, Big = 1);
+
+    const Big& num() const;
+    const Big& den() const;
+
+    explicit operator bool() const;
+
+    Rational inverse() const;
+    Rational pow(std::uint64_t) const;
+
+    Rational& operator+=(const Rational&);
+    Rational& operator-=(const Rational&);
+    Rational& operator*=(const Rational&);
+    Rational& operator/=(const Rational&);
+};
+
+inline
+Big& Big::_trim()
+{
+  while (!_limbs.empty() && !_limbs.back())
+    _limbs.pop_back();
+
+  return *this;
+}
+
+inline
+Big::Big(std::uint64_t value)
+  : _limbs({ std::uint32_t(value), std::uint32_t(value >> 32) })
+{
+  _trim();
+}
+
+inline
+Big::operator bool() const
+{
+  return !_limbs.empty();
+}
+
+inline
+int Big::compare(const Big& other) const
+{
+  if (_limbs.size() != other._limbs.size())
+    return _limbs.size() < other._limbs.size() ? -1 : 1;
+
+  for (std::size_t k = _limbs.size(); k--; )
+    if (_limbs[k] != other._limbs[k])
+      return _limbs[k] < other._limbs[k] ? -1 : 1;
+
+  return 0;
+}
+
+inline
+Big& Big::operator+=(const Big& other)
+{
+  std::uint64_t carry = 0;
+
+  _limbs.resize((std::max)(_limbs.size(), other._limbs.size()) + 1);
+
+  for (std::size_t k = 0; k < _limbs.size(); ++k) {
+    carry += _limbs[k] + std::uint64_t(k < other._limbs.size() ? other._limbs[k] : 0);
+    _limbs[k] = carry;
+    carry >>= 32;
+  }
+
+  return _trim();
+}
+
+// The other number must not exceed this one.
+inline
+Big& Big::operator-=(const Big& other)
+{
+  std::int64_t borrow = 0;
+
+  for (std::size_t k = 0; k < _limbs.size(); ++k) {
+    borrow += std::int64_t(_limbs[k]) - (k < other._limbs.size() ? other._limbs[k] : 0);
+    _limbs[k] = borrow;
+    borrow = borrow < 0 ? -1 : 0;
+  }
+
+  return _trim();
+}
+
+inline
+Big& Big::operator*=(const Big& other)
+{
+  std::vector<std::uint32_t> product(_limbs.size() + other._limbs.size());
+
+  for (std::size_t i = 0; i < _limbs.size(); ++i) {
+    std::uint64_t carry = 0;
+
+    for (std::size_t j = 0; j < other._limbs.size(); ++j) {
+      carry += product[i + j] + std::uint64_t(_limbs[i]) * other._limbs[j];
+      product[i + j] = carry;
+      carry >>= 32;
+    }
+
+    product[i + other._limbs.size()] = carry;
+  }
+
+  _limbs.swap(product);
+  return _trim();
+}
+
+inline
+Big operator*(Big x, const Big& y)
+{
+  return x *= y;
+}
+
+inline
+Rational::Rational(Big num, Big den)
+  : _num(num),
+    _den(den)
+{}
+
+inline
+const Big& Rational::num() const
+{
+  return _num;
+}
+
+inline
+const Big& Rational::den() const
+{
+  return _den;
+}
+
+inline
+Rational::operator bool() const
+{
+  return _num && _den;
+}
+
+inline
+Rational Rational::inverse() const
+{
+  return { _den, _num };
+}
+
+inline
+Rational Rational::pow(std::uint64_t exponent) const
+{
+  Rational base = *this;
+  Rational result = Big(1);
+
+  for (; exponent; exponent >>= 1) {
+    if (exponent & 1)
+      result *= base;
+
+    base *= base;
+  }
+
+  return result;
+}
+
+inline
+Rational& Rational::operator+=(const Rational& other)
+{
+  _num *= other._den;
+  _num += _den * other._num;
+  _den *= other._den;
+
+  return *this;
+}
+
+// Differences that are not positive are invalid.
+inline
+Rational& Rational::operator-=(const Rational& other)
+{
+  Big subtrahend = _den * other._num;
+
+  _num *= other._den;
+  _den *= other._den;
+
+  if (_num.compare(subtrahend) > 0)
+    _num -= subtrahend;
+  else
+    _num = _den = 0;
+
+  return *this;
+}
+
+inline
+Rational& Rational::operator*=(const Rational& other)
+{
+  _num *= other._num;
+  _den *= other._den;
+
+  return *this;
+}
+
+inline
+Rational& Rational::operator/=(const Rational& other)
+{
+  return *this *= other.inverse();
+}
+
+inline
+bool operator==(const Rational& x, const Rational& y)
+{
+  return x && y && (x.num() * y.den()).compare(y.num() * x.den()) == 0;
+}
+
+} // namespace Chic
+
+#endif // CHIC_BIG_HPP
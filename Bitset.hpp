@@ -0,0 +1,120 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_BITSET_HPP
+#define CHIC_BITSET_HPP
+
+#include "Integer.hpp"
+#include <vector>
+#include <cstdint>
+
+namespace Chic {
+
+// Set of integers below a bound, one bit each.  Shifted unions combine a
+// whole set with one integer a word at a time, which makes sumsets of
+// dense sets cheap.
+class Bitset
+{
+  private:
+    std::vector<std::uint64_t> _words;
+
+  public:
+    explicit Bitset(std::size_t bound = 0);
+
+    std::size_t bound() const;
+    void insert(std::size_t);
+    bool contains(std::size_t) const;
+
+    void shift_up(const Bitset&, std::size_t);
+    void shift_down(const Bitset&, std::size_t);
+
+    std::size_t next(std::size_t) const;
+};
+
+inline
+Bitset::Bitset(std::size_t bound)
+  : _words((bound + 63) / 64)
+{}
+
+inline
+std::size_t Bitset::bound() const
+{
+  return 64 * _words.size();
+}
+
+inline
+void Bitset::insert(std::size_t value)
+{
+  _words[value / 64] |= std::uint64_t(1) << value % 64;
+}
+
+inline
+bool Bitset::contains(std::size_t value) const
+{
+  return value < bound() && _words[value / 64] >> value % 64 & 1;
+}
+
+// Add s + shift for every s in the other set
+inline
+void Bitset::shift_up(const Bitset& other, std::size_t shift)
+{
+  std::size_t offset = shift / 64;
+  int bits = shift % 64;
+
+  for (std::size_t k = 0; k < other._words.size() && k + offset < _words.size(); ++k) {
+    _words[k + offset] |= other._words[k] << bits;
+
+    if (bits && k + offset + 1 < _words.size())
+      _words[k + offset + 1] |= other._words[k] >> (64 - bits);
+  }
+}
+
+// Add s - shift for every s at least shift in the other set
+inline
+void Bitset::shift_down(const Bitset& other, std::size_t shift)
+{
+  std::size_t offset = shift / 64;
+  int bits = shift % 64;
+
+  for (std::size_t k = 0; k < _words.size() && k + offset < other._words.size(); ++k) {
+    _words[k] |= other._words[k + offset] >> bits;
+
+    if (bits && k + offset + 1 < other._words.size())
+      _words[k] |= other._words[k + offset + 1] << (64 - bits);
+  }
+}
+
+// Least member not below the value, or the bound if there is none
+inline
+std::size_t Bitset::next(std::size_t value) const
+{
+  std::size_t k = value / 64;
+
+  if (k >= _words.size())
+    return bound();
+
+  std::uint64_t word = _words[k] & ~std::uint64_t(0) << value % 64;
+
+  while (!word && ++k < _words.size())
+    word = _words[k];
+
+  return word ? 64 * k + ctz(word) : bound();
+}
+
+} // namespace Chic
+
+#endif // CHIC_BITSET_HPP
@@ -0,0 +1,123 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_BUFFER_HPP
+#define CHIC_BUFFER_HPP
+
+#include <cstdio>
+#include <cstring>
+#include <streambuf>
+#include <vector>
+
+namespace Chic {
+
+// Stream buffer that collects output in one block allocated up front and
+// hands it to a C stream in large writes.  Only tellp() is supported for
+// seeking.
+class Buffer : public std::streambuf
+{
+  private:
+    std::vector<char> _storage;
+    std::FILE* _file;
+    std::streamoff _written;
+
+    bool _flush();
+
+  protected:
+    int_type overflow(int_type) override;
+    std::streamsize xsputn(const char*, std::streamsize) override;
+    pos_type seekoff(off_type, std::ios_base::seekdir, std::ios_base::openmode) override;
+    int sync() override;
+
+  public:
+    explicit Buffer(std::FILE*, std::size_t capacity = 1 << 20);
+    ~Buffer();
+};
+
+inline
+Buffer::Buffer(std::FILE* file, std::size_t capacity)
+  : _storage(capacity),
+    _file(file),
+    _written(0)
+{
+  setp(_storage.data(), _storage.data() + _storage.size());
+}
+
+inline
+Buffer::~Buffer()
+{
+  _flush();
+}
+
+inline
+bool Buffer::_flush()
+{
+  std::size_t size = pptr() - pbase();
+  bool good = std::fwrite(pbase(), 1, size, _file) == size;
+
+  _written += size;
+  setp(_storage.data(), _storage.data() + _storage.size());
+  return good;
+}
+
+inline
+Buffer::int_type Buffer::overflow(int_type character)
+{
+  if (!_flush())
+    return traits_type::eof();
+
+  if (!traits_type::eq_int_type(character, traits_type::eof()))
+    sputc(traits_type::to_char_type(character));
+
+  return traits_type::not_eof(character);
+}
+
+inline
+std::streamsize Buffer::xsputn(const char* data, std::streamsize size)
+{
+  if (size > epptr() - pptr() && !_flush())
+    return 0;
+
+  if (size > epptr() - pptr()) {
+    size = std::fwrite(data, 1, size, _file);
+    _written += size;
+    return size;
+  }
+
+  std::memcpy(pptr(), data, size);
+  pbump(size);
+  return size;
+}
+
+inline
+Buffer::pos_type Buffer::seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode mode)
+{
+  if (offset || direction != std::ios_base::cur || !(mode & std::ios_base::out))
+    return pos_type(off_type(-1));
+
+  return _written + (pptr() - pbase());
+}
+
+inline
+int Buffer::sync()
+{
+  return _flush() && !std::fflush(_file) ? 0 : -1;
+}
+
+} // namespace Chic
+
+#endif // CHIC_BUFFER_HPP
@@ -0,0 +1,93 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_CACHE_HPP
+#define CHIC_CACHE_HPP
+
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace Chic {
+
+template<typename Key, typename Value>
+class Cache
+{
+  private:
+    typedef std::list<std::pair<Key, Value>> List;
+
+    List _list;
+    std::unordered_map<Key, typename List::iterator> _index;
+    std::size_t _capacity;
+
+  public:
+    explicit Cache(std::size_t);
+
+    const Value* find(const Key&);
+    void insert(const Key&, Value);
+    std::size_t size() const;
+};
+
+template<typename Key, typename Value>
+Cache<Key, Value>::Cache(std::size_t capacity)
+  : _capacity(capacity)
+{}
+
+template<typename Key, typename Value>
+const Value* Cache<Key, Value>::find(const Key& key)
+{
+  auto found = _index.find(key);
+
+  if (found == _index.end())
+    return nullptr;
+
+  _list.splice(_list.begin(), _list, found->second);
+  return &found->second->second;
+}
+
+template<typename Key, typename Value>
+void Cache<Key, Value>::insert(const Key& key, Value value)
+{
+  auto found = _index.find(key);
+
+  if (found != _index.end()) {
+    found->second->second = std::move(value);
+    _list.splice(_list.begin(), _list, found->second);
+    return;
+  }
+
+  if (!_capacity)
+    return;
+
+  if (_list.size() == _capacity) {
+    _index.erase(_list.back().first);
+    _list.pop_back();
+  }
+
+  _list.emplace_front(key, std::move(value));
+  _index.emplace(key, _list.begin());
+}
+
+template<typename Key, typename Value>
+std::size_t Cache<Key, Value>::size() const
+{
+  return _list.size();
+}
+
+} // namespace Chic
+
+#endif // CHIC_CACHE_HPP
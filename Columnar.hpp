@@ -0,0 +1,515 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_COLUMNAR_HPP
+#define CHIC_COLUMNAR_HPP
+
+#include "Dictionary.hpp"
+#include "Step.hpp"
+#include <algorithm>
+#include <fstream>
+#include <ostream>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Chic {
+
+enum class Column { num, den, first, second, base, code };
+
+// Columnar dump of the levels of a dictionary
+//
+// The file starts with a header and ends with a directory of extents, one
+// per level and column, followed by a trailer pointing at the directory.
+// An extent is a run of blocks of at most `rows` values, each starting on an
+// `alignment` boundary.  A block holds its values minus `base`, packed in
+// `bits` bits each.  Uncompressed blocks have a zero base and 64 bits, so
+// they can be scanned in place as arrays.
+//
+// Operands refer to rows counted across levels from 1, and 0 means none.
+// Integral dictionaries have no den column.
+class Columns
+{
+  public:
+    static const std::size_t columns = 6;
+    static const std::size_t rows = 1 << 16;
+    static const std::size_t alignment = 4096;
+
+    struct Header
+    {
+      char magic[8];
+      std::uint32_t digit;
+      std::uint32_t rational;
+    };
+
+    struct Block
+    {
+      std::uint64_t base;
+      std::uint32_t bits;
+      std::uint32_t rows;
+    };
+
+    struct Extent
+    {
+      std::uint64_t offset;
+      std::uint64_t rows;
+    };
+
+    struct Trailer
+    {
+      std::uint64_t directory;
+      std::uint64_t levels;
+      char magic[8];
+    };
+
+  private:
+    const char* _data;
+    std::size_t _size;
+    std::vector<char> _buffer;
+
+    const Header& _header() const;
+    const Trailer& _trailer() const;
+    const Extent& _extent(std::size_t, Column) const;
+    std::uint64_t _next(std::uint64_t) const;
+    bool _valid() const;
+    void _release();
+
+  public:
+    explicit Columns(const char*);
+    ~Columns();
+
+    Columns(const Columns&) = delete;
+    Columns& operator=(const Columns&) = delete;
+
+    explicit operator bool() const;
+    int digit() const;
+    bool rational() const;
+    std::size_t levels() const;
+    std::uint64_t size(std::size_t) const;
+
+    template<typename Function>
+    Function scan(std::size_t, Column, Function) const;
+};
+
+namespace detail {
+
+template<typename Unsigned>
+std::uint64_t num(Entry<Unsigned> key)
+{
+  return key.value();
+}
+
+template<typename Unsigned>
+std::uint64_t num(Fraction<Unsigned> key)
+{
+  return key.num();
+}
+
+template<typename Unsigned>
+std::uint64_t den(Fraction<Unsigned> key)
+{
+  return key.den();
+}
+
+template<typename Unsigned>
+std::uint64_t den(Entry<Unsigned>)
+{
+  return 1;
+}
+
+template<typename Unsigned>
+bool rational(Entry<Unsigned>)
+{
+  return false;
+}
+
+template<typename Unsigned>
+bool rational(Fraction<Unsigned>)
+{
+  return true;
+}
+
+template<typename Key>
+bool less(Key x, Key y)
+{
+  return num(x) < num(y) || (num(x) == num(y) && den(x) < den(y));
+}
+
+// Positions of the keys of a level in increasing order, or none if the level
+// is already sorted, as integral levels are.  Levels are far below 2^32 keys.
+template<typename Level>
+std::vector<std::uint32_t> order(const Level& keys)
+{
+  typedef typename Level::value_type Key;
+
+  std::vector<std::uint32_t> positions;
+
+  if (std::is_sorted(keys.begin(), keys.end(), less<Key>))
+    return positions;
+
+  positions.resize(keys.size());
+
+  for (std::size_t k = 0; k < keys.size(); ++k)
+    positions[k] = k;
+
+  std::sort(positions.begin(), positions.end(), [&](std::uint32_t x, std::uint32_t y) { return less(keys[x], keys[y]); });
+  return positions;
+}
+
+// Row of an operand, or 0 for none.  The digits of the operand give its
+// level, and a binary search gives its position in that level.
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+std::uint64_t row(const Dictionary<Key, Monitor, Storage, Policy>& dictionary, const std::vector<std::uint64_t>& starts,
+  const std::vector<std::vector<std::uint32_t>>& orders, Key key)
+{
+  std::size_t digits = dictionary.digits(key);
+
+  if (!digits || digits > orders.size())
+    return 0;
+
+  const auto& keys = dictionary[digits - 1];
+  const std::vector<std::uint32_t>& positions = orders[digits - 1];
+  std::size_t position = keys.size();
+
+  if (positions.empty()) {
+    position = std::lower_bound(keys.begin(), keys.end(), key, less<Key>) - keys.begin();
+  }
+  else {
+    auto found = std::lower_bound(positions.begin(), positions.end(), key, [&](std::uint32_t k, Key other) { return less(keys[k], other); });
+
+    if (found != positions.end())
+      position = *found;
+  }
+
+  return position < keys.size() && keys[position] == key ? starts[digits - 1] + position + 1 : 0;
+}
+
+inline
+std::uint64_t pad(std::ostream& stream, std::uint64_t offset)
+{
+  static const char zeros[Columns::alignment] = {};
+  std::uint64_t padding = -offset & (Columns::alignment - 1);
+
+  stream.write(zeros, padding);
+  return offset + padding;
+}
+
+// Write values in blocks and return the offset past them
+inline
+std::uint64_t blocks(std::ostream& stream, std::uint64_t offset, const std::vector<std::uint64_t>& values, bool compress)
+{
+  std::vector<std::uint64_t> words;
+
+  for (std::size_t first = 0; first < values.size(); first += Columns::rows) {
+    std::size_t last = (std::min)(first + Columns::rows, values.size());
+    Columns::Block block = { 0, 64, std::uint32_t(last - first) };
+
+    if (compress) {
+      auto range = std::minmax_element(values.begin() + first, values.begin() + last);
+      std::uint64_t span = *range.second - *range.first;
+
+      block.base = *range.first;
+      block.bits = 0;
+
+      while (block.bits < 64 && span >> block.bits)
+        ++block.bits;
+    }
+
+    words.assign((std::uint64_t(block.rows) * block.bits + 63) / 64, 0);
+
+    for (std::size_t k = first; k < last; ++k) {
+      std::uint64_t value = values[k] - block.base;
+      std::uint64_t position = (k - first) * block.bits;
+
+      if (block.bits) {
+        words[position / 64] |= value << position % 64;
+
+        if (position % 64 + block.bits > 64)
+          words[position / 64 + 1] |= value >> (64 - position % 64);
+      }
+    }
+
+    offset = pad(stream, offset);
+    stream.write(reinterpret_cast<const char*>(&block), sizeof(block));
+    stream.write(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(std::uint64_t));
+    offset += sizeof(block) + words.size() * sizeof(std::uint64_t);
+  }
+
+  return offset;
+}
+
+} // namespace detail
+
+// Stream every level of a dictionary to columns, optionally packed to the
+// width each block needs.  Rows of operands are found by their rank in their
+// level, so the dump copies no keys, and only unsorted levels keep an order
+// of 32-bit positions.
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+bool columnar(std::ostream& stream, const Dictionary<Key, Monitor, Storage, Policy>& dictionary, bool compress = false)
+{
+  Columns::Header header = { { 'C', 'H', 'I', 'C', 'C', 'O', 'L', '1' }, std::uint32_t(dictionary.digit), detail::rational(Key()) };
+  std::vector<std::uint64_t> starts;
+  std::vector<std::vector<std::uint32_t>> orders;
+  std::vector<Columns::Extent> directory;
+  std::vector<std::uint64_t> values[Columns::columns];
+  std::uint64_t offset = sizeof(header);
+
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  for (std::size_t level = 0; level < dictionary.level(); ++level) {
+    const auto& keys = dictionary[level];
+
+    for (auto& column: values)
+      column.clear();
+
+    // Sorted levels may list a key before the operand it was made from
+    starts.push_back(level ? starts.back() + dictionary[level - 1].size() : 0);
+    orders.push_back(detail::order(keys));
+
+    for (Key key: keys) {
+      Step<Key> step = dictionary.step(key);
+
+      values[int(Column::num)].push_back(detail::num(key));
+      values[int(Column::first)].push_back(step.note().base() ? detail::row(dictionary, starts, orders, step.first()) : 0);
+      values[int(Column::second)].push_back(step.second() ? detail::row(dictionary, starts, orders, step.second()) : 0);
+      values[int(Column::base)].push_back(std::uint8_t(step.note().base()));
+      values[int(Column::code)].push_back(std::uint8_t(step.note().code()));
+    }
+
+    if (header.rational)
+      for (Key key: keys)
+        values[int(Column::den)].push_back(detail::den(key));
+
+    for (const auto& column: values) {
+      Columns::Extent extent = { detail::pad(stream, offset), column.size() };
+
+      directory.push_back(extent);
+      offset = detail::blocks(stream, extent.offset, column, compress);
+    }
+  }
+
+  Columns::Trailer trailer = { detail::pad(stream, offset), dictionary.level(), { 'C', 'H', 'I', 'C', 'C', 'O', 'L', '1' } };
+
+  stream.write(reinterpret_cast<const char*>(directory.data()), directory.size() * sizeof(Columns::Extent));
+  stream.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+
+  return stream.good();
+}
+
+inline
+Columns::Columns(const char* path)
+  : _data(nullptr),
+    _size(0)
+{
+  #if defined(__unix__) || defined(__APPLE__)
+    int descriptor = open(path, O_RDONLY);
+    struct stat status;
+
+    if (descriptor < 0)
+      return;
+
+    if (fstat(descriptor, &status) == 0 && status.st_size) {
+      void* map = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+
+      if (map != MAP_FAILED) {
+        _data = static_cast<const char*>(map);
+        _size = status.st_size;
+      }
+    }
+
+    close(descriptor);
+  #else
+    std::ifstream stream(path, std::ios_base::binary);
+    _buffer.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    _data = _buffer.data();
+    _size = _buffer.size();
+  #endif
+
+  if (_size < sizeof(Header) + sizeof(Trailer) || std::memcmp(_header().magic, "CHICCOL1", sizeof(Header::magic))
+      || std::memcmp(_trailer().magic, "CHICCOL1", sizeof(Trailer::magic)) || !_valid())
+    _release();
+}
+
+inline
+Columns::~Columns()
+{
+  _release();
+}
+
+inline
+void Columns::_release()
+{
+  #if defined(__unix__) || defined(__APPLE__)
+    if (_data)
+      munmap(const_cast<char*>(_data), _size);
+  #endif
+
+  _data = nullptr;
+  _size = 0;
+}
+
+inline
+const Columns::Header& Columns::_header() const
+{
+  return *reinterpret_cast<const Header*>(_data);
+}
+
+inline
+const Columns::Trailer& Columns::_trailer() const
+{
+  return *reinterpret_cast<const Trailer*>(_data + _size - sizeof(Trailer));
+}
+
+inline
+const Columns::Extent& Columns::_extent(std::size_t level, Column column) const
+{
+  return reinterpret_cast<const Extent*>(_data + _trailer().directory)[level * columns + int(column)];
+}
+
+// Offset of the block after the one at `offset`
+inline
+std::uint64_t Columns::_next(std::uint64_t offset) const
+{
+  const Block& block = *reinterpret_cast<const Block*>(_data + offset);
+
+  offset += sizeof(Block) + (std::uint64_t(block.rows) * block.bits + 63) / 64 * sizeof(std::uint64_t);
+  return offset + (-offset & (alignment - 1));
+}
+
+// Whether the directory, every extent and every block header lie within the
+// file, so that truncated or corrupt files are rejected before any scan.  A
+// level has as many rows in every column, except an empty den column in an
+// integral dump.
+inline
+bool Columns::_valid() const
+{
+  const std::uint64_t directory = _trailer().directory;
+  const std::uint64_t levels = _trailer().levels;
+  const std::uint64_t end = _size - sizeof(Trailer);
+
+  if (directory < sizeof(Header) || directory > end || directory % alignment
+      || (end - directory) % (columns * sizeof(Extent)) || (end - directory) / (columns * sizeof(Extent)) != levels)
+    return false;
+
+  for (std::uint64_t level = 0; level < levels; ++level) {
+    for (std::size_t column = 0; column < columns; ++column) {
+      const Extent& extent = _extent(level, Column(column));
+      std::uint64_t offset = extent.offset;
+
+      if (extent.rows != (Column(column) == Column::den && !_header().rational ? 0 : _extent(level, Column::num).rows))
+        return false;
+
+      for (std::uint64_t remaining = extent.rows; remaining; offset = _next(offset)) {
+        if (offset < sizeof(Header) || offset % alignment || offset > directory || directory - offset < sizeof(Block))
+          return false;
+
+        const Block& block = *reinterpret_cast<const Block*>(_data + offset);
+        std::uint64_t words = (std::uint64_t(block.rows) * block.bits + 63) / 64;
+
+        if (!block.rows || block.rows > rows || block.rows > remaining || block.bits > 64
+            || (directory - offset - sizeof(Block)) / sizeof(std::uint64_t) < words)
+          return false;
+
+        remaining -= block.rows;
+      }
+    }
+  }
+
+  return true;
+}
+
+inline
+Columns::operator bool() const
+{
+  return _data;
+}
+
+inline
+int Columns::digit() const
+{
+  return _data ? _header().digit : 0;
+}
+
+inline
+bool Columns::rational() const
+{
+  return _data && _header().rational;
+}
+
+inline
+std::size_t Columns::levels() const
+{
+  return _data ? _trailer().levels : 0;
+}
+
+inline
+std::uint64_t Columns::size(std::size_t level) const
+{
+  return level < levels() ? _extent(level, Column::num).rows : 0;
+}
+
+// Call f(value) for each row of a column in a level, touching only the
+// blocks of that column.  Levels and columns out of range have no rows.
+template<typename Function>
+Function Columns::scan(std::size_t level, Column column, Function f) const
+{
+  if (level >= levels() || std::size_t(column) >= columns)
+    return f;
+
+  const Extent& extent = _extent(level, column);
+  std::uint64_t offset = extent.offset;
+
+  for (std::uint64_t remaining = extent.rows; remaining; offset = _next(offset)) {
+    const Block& block = *reinterpret_cast<const Block*>(_data + offset);
+    const std::uint64_t* words = reinterpret_cast<const std::uint64_t*>(&block + 1);
+    const std::uint64_t mask = block.bits < 64 ? (std::uint64_t(1) << block.bits) - 1 : -1;
+
+    if (!block.bits) {
+      for (std::uint32_t k = 0; k < block.rows; ++k)
+        f(block.base);
+    }
+    else if (block.bits == 64) {
+      for (std::uint32_t k = 0; k < block.rows; ++k)
+        f(block.base + words[k]);
+    }
+    else {
+      for (std::uint64_t k = 0, position = 0; k < block.rows; ++k, position += block.bits) {
+        std::uint64_t value = words[position / 64] >> position % 64;
+
+        if (position % 64 + block.bits > 64)
+          value |= words[position / 64 + 1] << (64 - position % 64);
+
+        f(block.base + (value & mask));
+      }
+    }
+
+    remaining -= block.rows;
+  }
+
+  return f;
+}
+
+} // namespace Chic
+
+#endif // CHIC_COLUMNAR_HPP
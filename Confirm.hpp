@@ -0,0 +1,141 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_CONFIRM_HPP
+#define CHIC_CONFIRM_HPP
+
+#include "Big.hpp"
+#include "Dictionary.hpp"
+#include "Residue.hpp"
+#include "Step.hpp"
+#include <unordered_map>
+
+namespace Chic {
+
+namespace detail {
+
+typedef std::unordered_map<Residue, Step<Residue>> Steps;
+
+inline
+Rational factorial(std::uint64_t x, std::uint64_t y)
+{
+  Big product = 1;
+
+  for (std::uint64_t k = y + 1; k <= x; ++k)
+    product *= k;
+
+  return product;
+}
+
+// Exact value of a key, or 0 if its residues were wrong
+inline
+Rational exact(const Steps& steps, int digit, Residue key)
+{
+  auto found = steps.find(key);
+
+  if (found == steps.end()) {
+    Big value = 0;
+
+    for (std::size_t repeats = 1; repeats <= std::size_t(Residue::bits); ++repeats) {
+      value *= 10;
+      value += digit;
+
+      if (Residue(Concatenate, repeats, digit) == key)
+        return value;
+    }
+
+    return Rational();
+  }
+
+  Step<Residue> step = found->second;
+  Rational x = exact(steps, digit, step.first());
+  Rational y = step.second() ? exact(steps, digit, step.second()) : Rational();
+  std::uint64_t a = step.first().integer();
+  std::uint64_t b = step.second() ? step.second().integer() : 0;
+
+  switch (step.note().base()) {
+    case '+':
+      return x += y;
+    case '-':
+      return x -= y;
+    case '*':
+      return x *= y;
+    case '/':
+      return x /= y;
+    case 's':
+      if (std::uint64_t root = key.integer())
+        if (Rational(Big(root) * root) == x)
+          return Big(root);
+      return Rational();
+    case '!':
+      if (!(a && x == Big(a)))
+        return Rational();
+      if (!step.note().code())
+        return factorial(a, 0);
+      if (!(b && y == Big(b)))
+        return Rational();
+      x = a > b ? factorial(a, b) : factorial(b, a).inverse();
+      switch (step.note().code()) {
+        case '+':
+          return x += Big(1);
+        case '-':
+          return x -= Big(1);
+      }
+      return x;
+    case '^': {
+      if (!(b && y == Big(b)))
+        return Rational();
+
+      signed char code = step.note().code();
+      bool negative = code < 0;
+      int shift = negative ? ~code : code;
+      Rational power = x.pow(b);
+
+      if (shift) {
+        std::uint64_t root = (negative ? key.inverse() : key).integer();
+
+        if (!(root && Rational(root).pow(std::uint64_t(1) << shift) == power))
+          return Rational();
+
+        power = Big(root);
+      }
+
+      return negative ? power.inverse() : power;
+    }
+  }
+
+  return Rational();
+}
+
+} // namespace detail
+
+// Replay the breakdown of a key with exact arithmetic, and tell whether it
+// makes the target.  Answers found with Residue keys are only candidates
+// until confirmed.
+template<typename Monitor, typename Storage, typename Policy>
+bool confirm(const Dictionary<Residue, Monitor, Storage, Policy>& dictionary, Residue key, const Rational& target)
+{
+  detail::Steps steps;
+
+  dictionary.bfs(key, [&steps](Residue key, Step<Residue> step) { steps.emplace(key, step); });
+
+  return detail::exact(steps, dictionary.digit, key) == target;
+}
+
+} // namespace Chic
+
+#endif // CHIC_CONFIRM_HPP
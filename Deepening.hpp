@@ -0,0 +1,279 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_DEEPENING_HPP
+#define CHIC_DEEPENING_HPP
+
+#include "Dictionary.hpp"
+#include "Step.hpp"
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+namespace Chic {
+
+// Iterative deepening toward a single target beyond the levels materialized
+// in a dictionary.  Each step peels an operand off the target by inverting
+// an operation against a materialized key, and searches for the other
+// operand depth-first.  Only the winning chain of steps is kept, and failed
+// targets are remembered in a table of bounded size.
+//
+// Expressions whose every binary step has a materialized side are covered,
+// save for factorial quotients and runs of more than two unary steps.  The
+// operands of a binary step in an answer of at most 2n + 1 digits cannot
+// both exceed n digits, so such answers are complete up to those
+// exceptions when n levels are materialized.  Deeper answers are upper
+// bounds.  A target may have no answer at all, so the search needs a limit.
+template<typename Key, typename Monitor = Silent>
+class Deepening
+{
+  private:
+    static const int unary = 2;
+
+    const Dictionary<Key, Monitor>& _dictionary;
+    std::unordered_map<Key, Step<Key>> _steps;
+    std::unordered_map<Key, std::size_t> _failed;
+    std::size_t _capacity;
+
+    template<typename Unsigned>
+    static Entry<Unsigned> _root(Entry<Unsigned>, Entry<Unsigned>);
+
+    template<typename Unsigned>
+    static Fraction<Unsigned> _root(Fraction<Unsigned>, Fraction<Unsigned>);
+
+    bool _leaf(Key, std::size_t);
+    bool _try(Key, Key, Step<Key>, std::size_t, int);
+    bool _invert(Key, Key, std::size_t);
+    bool _logarithm(Key, Key, std::size_t);
+    bool _solve(Key, std::size_t, int);
+
+    template<typename Function>
+    Function _leaves(const std::vector<Key>&, std::size_t, Function) const;
+
+  public:
+    explicit Deepening(const Dictionary<Key, Monitor>&, std::size_t capacity = 1 << 20);
+
+    std::size_t search(Key, std::size_t limit);
+
+    template<typename Function>
+    Function bfs(Key, Function) const;
+};
+
+template<typename Key, typename Monitor>
+Deepening<Key, Monitor>::Deepening(const Dictionary<Key, Monitor>& dictionary, std::size_t capacity)
+  : _dictionary(dictionary),
+    _capacity(capacity)
+{}
+
+template<typename Key, typename Monitor>
+template<typename Unsigned>
+Entry<Unsigned> Deepening<Key, Monitor>::_root(Entry<Unsigned> power, Entry<Unsigned> index)
+{
+  Unsigned exponent = index;
+
+  if (exponent < 2 || exponent >= std::numeric_limits<Unsigned>::digits)
+    return 0;
+
+  Unsigned root = std::llround(std::pow(double(power.value()), 1.0 / exponent));
+
+  for (Unsigned candidate = root ? root - 1 : 0; candidate <= root + 1; ++candidate)
+    if (candidate > 1 && Entry<Unsigned>(candidate).pow(exponent) == power)
+      return candidate;
+
+  return 0;
+}
+
+template<typename Key, typename Monitor>
+template<typename Unsigned>
+Fraction<Unsigned> Deepening<Key, Monitor>::_root(Fraction<Unsigned> power, Fraction<Unsigned> exponent)
+{
+  if (exponent.den() != 1)
+    return Fraction<Unsigned>::nan();
+
+  Entry<Unsigned> num = _root(Entry<Unsigned>(power.num()), Entry<Unsigned>(exponent.num()));
+  Entry<Unsigned> den = power.den() == 1 ? Entry<Unsigned>(1) : _root(Entry<Unsigned>(power.den()), Entry<Unsigned>(exponent.num()));
+
+  if (num && den)
+    return { num, den };
+
+  return Fraction<Unsigned>::nan();
+}
+
+template<typename Key, typename Monitor>
+bool Deepening<Key, Monitor>::_leaf(Key target, std::size_t digits)
+{
+  if (_dictionary.reachable(target, digits))
+    return true;
+
+  for (std::size_t repeats = _dictionary.level() + 1; repeats <= digits; ++repeats) {
+    if (Key(Concatenate, repeats, _dictionary.digit) == target) {
+      _steps[target] = Step<Key>(target);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+template<typename Key, typename Monitor>
+bool Deepening<Key, Monitor>::_try(Key target, Key operand, Step<Key> step, std::size_t digits, int chain)
+{
+  if (_solve(operand, digits, chain)) {
+    _steps.emplace(target, step);
+    return true;
+  }
+
+  return false;
+}
+
+template<typename Key, typename Monitor>
+bool Deepening<Key, Monitor>::_invert(Key target, Key x, std::size_t digits)
+{
+  Key sum = target - x;
+  Key difference = x - target;
+  Key minuend = target + x;
+  Key factor = target / x;
+  Key divisor = x / target;
+  Key dividend = target * x;
+  Key base = _root(target, x);
+
+  return _try(target, sum, { x, sum, '+' }, digits, unary)
+    || _try(target, difference, { x, difference, '-' }, digits, unary)
+    || _try(target, minuend, { minuend, x, '-' }, digits, unary)
+    || _try(target, factor, { x, factor, '*' }, digits, unary)
+    || _try(target, divisor, { x, divisor, '/' }, digits, unary)
+    || _try(target, dividend, { dividend, x, '/' }, digits, unary)
+    || _try(target, base, { base, x, {'^', 0} }, digits, unary)
+    || _logarithm(target, x, digits);
+}
+
+template<typename Key, typename Monitor>
+bool Deepening<Key, Monitor>::_logarithm(Key target, Key x, std::size_t digits)
+{
+  if (x == Key(1))
+    return false;
+
+  Key power = x * x;
+
+  for (int exponent = 2; std::isnormal(power); ++exponent, power *= x)
+    if (power == target)
+      return _try(target, Key(exponent), { x, Key(exponent), {'^', 0} }, digits, unary);
+
+  return false;
+}
+
+template<typename Key, typename Monitor>
+bool Deepening<Key, Monitor>::_solve(Key target, std::size_t digits, int chain)
+{
+  if (!std::isnormal(target))
+    return false;
+
+  if (_leaf(target, digits))
+    return true;
+
+  std::size_t size = _dictionary.level();
+
+  if (digits <= size)
+    return false;
+
+  auto failed = _failed.find(target);
+
+  if (failed != _failed.end() && failed->second >= digits)
+    return false;
+
+  if (chain) {
+    if (_try(target, target * target, { target * target, 's' }, digits, chain - 1))
+      return true;
+
+    Key factorial = Key(3).factorial();
+
+    for (int n = 3; std::isnormal(factorial); factorial = Key(++n).factorial())
+      if (factorial == target)
+        return _try(target, Key(n), { Key(n), '!' }, digits, chain - 1);
+  }
+
+  for (std::size_t length = 1; length <= size && length < digits; ++length)
+    for (Key x: _dictionary[length - 1])
+      if (_invert(target, x, digits - length))
+        return true;
+
+  if (chain == unary) {
+    if (_failed.size() >= _capacity)
+      _failed.clear();
+
+    _failed[target] = digits;
+  }
+
+  return false;
+}
+
+// Search answers of fewer than `limit` digits.  Return the digits of the
+// answer, or 0 if there is none.
+template<typename Key, typename Monitor>
+std::size_t Deepening<Key, Monitor>::search(Key target, std::size_t limit)
+{
+  _steps.clear();
+
+  for (std::size_t digits = _dictionary.level() + 1; digits < limit; ++digits)
+    if (_solve(target, digits, unary))
+      return digits;
+
+  return 0;
+}
+
+template<typename Key, typename Monitor>
+template<typename Function>
+Function Deepening<Key, Monitor>::_leaves(const std::vector<Key>& leaves, std::size_t index, Function f) const
+{
+  if (index == leaves.size())
+    return f;
+
+  return _leaves(leaves, index + 1, _dictionary.bfs(leaves[index], f));
+}
+
+template<typename Key, typename Monitor>
+template<typename Function>
+Function Deepening<Key, Monitor>::bfs(Key target, Function f) const
+{
+  std::vector<Key> queue = { target };
+  std::vector<Key> leaves;
+
+  for (std::size_t index = 0; index < queue.size(); ++index) {
+    auto found = _steps.find(queue[index]);
+
+    if (found == _steps.end()) {
+      leaves.push_back(queue[index]);
+      continue;
+    }
+
+    Step<Key> step = found->second;
+
+    if (step.note().base()) {
+      f(queue[index], step);
+      queue.push_back(step.first());
+
+      if (step.second())
+        queue.push_back(step.second());
+    }
+  }
+
+  return _leaves(leaves, 0, f);
+}
+
+} // namespace Chic
+
+#endif // CHIC_DEEPENING_HPP
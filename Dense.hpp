@@ -0,0 +1,215 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_DENSE_HPP
+#define CHIC_DENSE_HPP
+
+#include "Entry.hpp"
+#include "Integer.hpp"
+#include "Step.hpp"
+#include <vector>
+#include <cassert>
+#include <cstdint>
+
+namespace Chic {
+
+// Direct-indexed tier for small keys.  Keys of other types never fall
+// below its bound, so it stays empty.
+template<typename Key>
+class Dense
+{
+  public:
+    void resize(std::uintmax_t);
+    std::uintmax_t bound() const;
+    bool covers(Key) const;
+    bool emplace(Key, Step<Key>, std::size_t);
+    std::size_t digits(Key) const;
+    Step<Key> at(Key) const;
+    std::uintmax_t unreachable() const;
+    std::size_t size() const;
+    std::size_t bytes() const;
+};
+
+// Integers below the bound are indexed by value.  A cell holds the digits
+// of its key in the low 5 bits and the index of its step above them, and a
+// bitmap of the same range marks members for fast scans.
+template<typename Unsigned>
+class Dense<Entry<Unsigned>>
+{
+  private:
+    typedef Entry<Unsigned> Key;
+
+    std::vector<std::uint32_t> _cells;
+    std::vector<std::uint64_t> _bits;
+    std::vector<Step<Key>> _steps;
+
+  public:
+    static const std::uintmax_t limit = std::uintmax_t(1) << 27;
+
+    void resize(std::uintmax_t);
+    std::uintmax_t bound() const;
+    bool covers(Key) const;
+    bool emplace(Key, Step<Key>, std::size_t);
+    std::size_t digits(Key) const;
+    Step<Key> at(Key) const;
+    std::uintmax_t unreachable() const;
+    std::size_t size() const;
+    std::size_t bytes() const;
+};
+
+template<typename Key>
+void Dense<Key>::resize(std::uintmax_t)
+{}
+
+template<typename Key>
+std::uintmax_t Dense<Key>::bound() const
+{
+  return 0;
+}
+
+template<typename Key>
+bool Dense<Key>::covers(Key) const
+{
+  return false;
+}
+
+template<typename Key>
+bool Dense<Key>::emplace(Key, Step<Key>, std::size_t)
+{
+  return false;
+}
+
+template<typename Key>
+std::size_t Dense<Key>::digits(Key) const
+{
+  return 0;
+}
+
+template<typename Key>
+Step<Key> Dense<Key>::at(Key) const
+{
+  return {};
+}
+
+template<typename Key>
+std::uintmax_t Dense<Key>::unreachable() const
+{
+  return 0;
+}
+
+template<typename Key>
+std::size_t Dense<Key>::size() const
+{
+  return 0;
+}
+
+template<typename Key>
+std::size_t Dense<Key>::bytes() const
+{
+  return 0;
+}
+
+// Index keys below `bound`, at most `limit`.  Zero is marked in the bitmap
+// so that scans skip it.
+template<typename Unsigned>
+void Dense<Entry<Unsigned>>::resize(std::uintmax_t bound)
+{
+  if (bound > limit)
+    bound = limit;
+
+  _cells.assign(bound, 0);
+  _bits.assign((bound + 63) / 64, 0);
+  _steps.clear();
+
+  if (bound)
+    _bits[0] = 1;
+}
+
+template<typename Unsigned>
+std::uintmax_t Dense<Entry<Unsigned>>::bound() const
+{
+  return _cells.size();
+}
+
+template<typename Unsigned>
+bool Dense<Entry<Unsigned>>::covers(Key key) const
+{
+  return key.value() < _cells.size();
+}
+
+// Each key is emplaced once, so resize() keeps the index of its step within
+// 27 bits.  The digits must fit the other 5, which any level a machine can
+// hold does.
+template<typename Unsigned>
+bool Dense<Entry<Unsigned>>::emplace(Key key, Step<Key> step, std::size_t digits)
+{
+  std::uint32_t& cell = _cells[key.value()];
+
+  if (cell)
+    return false;
+
+  assert(_steps.size() < limit);
+  assert(digits && digits < 32);
+
+  cell = std::uint32_t(_steps.size()) << 5 | std::uint32_t(digits);
+  _bits[key.value() / 64] |= std::uint64_t(1) << key.value() % 64;
+  _steps.push_back(step);
+
+  return true;
+}
+
+template<typename Unsigned>
+std::size_t Dense<Entry<Unsigned>>::digits(Key key) const
+{
+  return _cells[key.value()] & 31;
+}
+
+template<typename Unsigned>
+Step<Entry<Unsigned>> Dense<Entry<Unsigned>>::at(Key key) const
+{
+  return _steps[_cells[key.value()] >> 5];
+}
+
+// The least positive integer missing from the tier, or 0 if none is
+template<typename Unsigned>
+std::uintmax_t Dense<Entry<Unsigned>>::unreachable() const
+{
+  for (std::size_t k = 0; k < _bits.size(); ++k) {
+    if (~_bits[k]) {
+      std::uintmax_t value = 64 * k + ctz(~_bits[k]);
+      return value < _cells.size() ? value : 0;
+    }
+  }
+
+  return 0;
+}
+
+template<typename Unsigned>
+std::size_t Dense<Entry<Unsigned>>::size() const
+{
+  return _steps.size();
+}
+
+template<typename Unsigned>
+std::size_t Dense<Entry<Unsigned>>::bytes() const
+{
+  return _cells.capacity() * sizeof(std::uint32_t) + _bits.capacity() * sizeof(std::uint64_t) + _steps.capacity() * sizeof(Step<Key>);
+}
+
+} // namespace Chic
+
+#endif // CHIC_DENSE_HPP
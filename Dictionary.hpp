@@ -18,66 +18,259 @@
 #ifndef CHIC_DICTIONARY_HPP
 #define CHIC_DICTIONARY_HPP
 
+#include "Bitset.hpp"
+#include "Dense.hpp"
+#include "Filter.hpp"
+#include "Footprint.hpp"
 #include "Fraction.hpp"
+#include "Heap.hpp"
+#include "Monitor.hpp"
+#include "Operators.hpp"
+#include <algorithm>
+#include <chrono>
+#include <limits>
 #include <queue>
 #include <stack>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
+#include <cstdint>
 
 namespace Chic {
 
 template<typename> class Step;
 template<typename> class Entry;
 template<typename> class Fraction;
+template<typename> class Smooth;
+class Residue;
 
-template<typename> struct Reservation;
+} // namespace Chic
 
-template<typename Unsigned>
-struct Reservation<Entry<Unsigned>>
-{
-  static const std::size_t size = std::size_t(std::numeric_limits<Unsigned>::digits) << 19;
-};
+// The experimental keys are defined in Residue.hpp and Smooth.hpp, which only
+// their users include.  Dictionary qualifies calls to std::isnormal, so their
+// overloads must be declared before it.
+namespace std {
+
+inline bool isnormal(Chic::Residue);
 
 template<typename Unsigned>
-struct Reservation<Fraction<Unsigned>>
+bool isnormal(Chic::Smooth<Unsigned>);
+
+} // namespace std
+
+namespace Chic {
+
+// Growth on worker threads is defined in Workers.hpp
+class Workers;
+
+// Prediction of the next level of a dictionary
+struct Estimate
 {
-  static const std::size_t size = std::size_t(std::numeric_limits<Unsigned>::digits) << 20;
+  std::size_t keys;
+  std::size_t bytes;
+  double seconds;
 };
 
-template<typename Key>
+template<typename Key, typename Monitor = Silent, typename Storage = Heap, typename Policy = Operators<>>
 class Dictionary
 {
+  public:
+    typedef std::vector<Key, typename Storage::template Allocator<Key>> Level;
+
   private:
-    std::unordered_map<Key, Step<Key>> _graph;
-    std::vector<std::vector<Key>> _hierarchy;
+    struct Candidate
+    {
+      Key key;
+      Step<Key> step;
+      bool quadratic;
+    };
+
+    // Sinks of the candidates of a pair.  Insert adds them to the dictionary
+    // at once, while Collect keeps them to be merged later.
+    class Insert
+    {
+      private:
+        Dictionary& _dictionary;
+
+      public:
+        explicit Insert(Dictionary&);
+
+        void basic(Key, Step<Key>) const;
+        void quadratic(Key, Step<Key>) const;
+    };
+
+    // Cursor of _sumset through a length, which pauses like the sweep
+    struct Sumset
+    {
+      enum Stage { plan, fill, shift, add, subtract, done };
+
+      Stage stage;
+      std::size_t index;
+      std::size_t bound;
+      std::size_t nx;
+      std::size_t ny;
+
+      Bitset left;
+      Bitset right;
+      Bitset sums;
+      Bitset differences;
+    };
+
+    class Collect
+    {
+      private:
+        std::vector<Candidate>& _candidates;
+
+      public:
+        explicit Collect(std::vector<Candidate>&);
+
+        void basic(Key, Step<Key>) const;
+        void quadratic(Key, Step<Key>) const;
+    };
+
+    Storage _storage;
+    std::unordered_map<Key, Step<Key>, std::hash<Key>, std::equal_to<Key>, typename Storage::template Allocator<std::pair<const Key, Step<Key>>>> _graph;
+    Dense<Key> _dense;
+    std::vector<Level, typename Storage::template Allocator<Level>> _hierarchy;
+    Monitor _monitor;
+
+    std::size_t _memory;
+    bool _full;
+
+    std::uintmax_t _magnitude;
+    std::uintmax_t _denominator;
+    std::size_t _pruned;
+
+    bool _growing;
+    std::size_t _length;
+    std::size_t _first;
+    std::size_t _second;
+    std::uint_fast64_t _pairs;
+    std::uint_fast64_t _done;
+    std::uintmax_t _span;
+    Sumset _sums;
+
+    Key _watch;
+    bool _watching;
+    bool _seen;
+
+    std::vector<Filter<Key>> _filters;
+    Filter<Key> _reachable;
+
+    template<typename Unsigned>
+    bool _admissible(Entry<Unsigned>) const;
+
+    template<typename Unsigned>
+    bool _admissible(Fraction<Unsigned>) const;
+
+    template<typename Unsigned>
+    bool _admissible(Smooth<Unsigned>) const;
+
+    template<typename Other>
+    bool _admissible(Other) const;
 
     bool _basic(Key, Step<Key>);
     void _quadratic(Key, Step<Key>);
     void _factorial();
 
-    template<typename Unsigned>
-    void _divides(Entry<Unsigned>, Entry<Unsigned>);
+    template<typename Sink, typename Unsigned>
+    static void _divides(Sink, Entry<Unsigned>, Entry<Unsigned>);
+
+    template<typename Sink, typename Other>
+    static void _divides(Sink, Other, Other);
+
+    template<typename Sink, typename Unsigned>
+    static void _pow(Sink, Entry<Unsigned>, Entry<Unsigned>);
+
+    template<typename Sink, typename Unsigned>
+    static void _pow(Sink, Fraction<Unsigned>, Fraction<Unsigned>);
+
+    template<typename Sink, typename Other>
+    static void _pow(Sink, Other, Other);
+
+    template<typename Unsigned, typename Allocator>
+    static void _sort(std::vector<Entry<Unsigned>, Allocator>&);
 
     template<typename Other>
-    void _divides(Other, Other);
+    static void _sort(Other&);
 
     template<typename Unsigned>
-    void _pow(Entry<Unsigned>, Entry<Unsigned>);
+    static std::size_t _overflow(Entry<Unsigned>, const Level&);
+
+    template<typename Other>
+    static std::size_t _overflow(Other, const Level&);
+
+    template<typename Unsigned, typename Allocator>
+    bool _sumset(const std::vector<Entry<Unsigned>, Allocator>&, const std::vector<Entry<Unsigned>, Allocator>&, std::size_t&);
+
+    template<typename Other>
+    bool _sumset(const Other&, const Other&, std::size_t&);
 
     template<typename Unsigned>
-    void _pow(Fraction<Unsigned>, Fraction<Unsigned>);
+    std::size_t _covered(Entry<Unsigned>, const Level&) const;
 
-    void _binary(Key, Key);
-    void _neighbors(Key, Key);
+    template<typename Other>
+    std::size_t _covered(Other, const Level&) const;
+
+    template<typename Sink>
+    static void _combine(Sink, Key, Key, bool, bool);
+
+    template<typename Sink>
+    static void _binary(Sink, Key, Key);
+
+    template<typename Sink>
+    static void _large(Sink, Key, Key);
+
+    template<typename Sink>
+    static void _small(Sink, Key, Key);
+
+    template<typename Sink>
+    static void _neighbors(Sink, Key, Key);
+
+    void _open();
+    void _probe();
+    void _freeze();
+    bool _maybe(const Filter<Key>&, Key) const;
+    bool _has(Key) const;
+
+    template<void (*)(Insert, Key, Key)>
+    bool _sweep(const Level&, const Level&, std::size_t&);
+    void _sweep(const Level&, const Level&, Workers&);
 
   public:
     const int digit;
 
     Dictionary(int);
 
+    void cap(std::size_t);
+    std::size_t memory() const;
+    bool full() const;
+    void prune(std::uintmax_t magnitude, std::uintmax_t denominator = -1);
+    std::size_t pruned() const;
+    void dense(std::uintmax_t);
+    std::uintmax_t unreachable() const;
+    std::size_t predict() const;
+    Estimate estimate(std::size_t samples = 1 << 12);
+    std::size_t bytes(std::size_t = 0) const;
+
     void grow();
+    void grow(Workers&);
+    bool grow_some(std::size_t budget);
+    bool growing() const;
+    double progress() const;
+
+    void watch(Key);
+    void unwatch();
+
     bool build(Key, std::size_t limit = -1);
     std::size_t level() const;
+    std::size_t digits(Key) const;
+    bool contains(Key) const;
+    bool reachable(Key, std::size_t digits) const;
+    const Level& operator[](std::size_t) const;
+    Step<Key> step(Key) const;
+    const Storage& storage() const;
+    const Monitor& monitor() const;
 
     template<typename Container, typename Function>
     Function bfs(Key, Function) const;
@@ -92,39 +285,123 @@ class Dictionary
     Function dfs(Key, Function) const;
 };
 
-template<typename Key>
-Dictionary<Key>::Dictionary(int strain) :
-  #ifndef __APPLE__
-    _graph(Reservation<Key>::size),
-  #endif
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+Dictionary<Key, Monitor, Storage, Policy>::Dictionary(int strain)
+  : _graph(0, std::hash<Key>(), std::equal_to<Key>(), _storage.template allocator<std::pair<const Key, Step<Key>>>()),
+    _hierarchy(_storage.template allocator<Level>()),
+    _memory(-1),
+    _full(false),
+    _magnitude(-1),
+    _denominator(-1),
+    _pruned(0),
+    _growing(false),
+    _length(0),
+    _first(0),
+    _second(0),
+    _pairs(0),
+    _done(0),
+    _span(0),
+    _sums(),
+    _watching(false),
+    _seen(false),
     digit(strain)
 {}
 
-template<typename Key>
-bool Dictionary<Key>::_basic(Key key, Step<Key> step)
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+Dictionary<Key, Monitor, Storage, Policy>::Insert::Insert(Dictionary& dictionary)
+  : _dictionary(dictionary)
+{}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+void Dictionary<Key, Monitor, Storage, Policy>::Insert::basic(Key key, Step<Key> step) const
+{
+  _dictionary._basic(key, step);
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+void Dictionary<Key, Monitor, Storage, Policy>::Insert::quadratic(Key key, Step<Key> step) const
+{
+  _dictionary._quadratic(key, step);
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+Dictionary<Key, Monitor, Storage, Policy>::Collect::Collect(std::vector<Candidate>& candidates)
+  : _candidates(candidates)
+{}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+void Dictionary<Key, Monitor, Storage, Policy>::Collect::basic(Key key, Step<Key> step) const
+{
+  _candidates.push_back({ key, step, false });
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+void Dictionary<Key, Monitor, Storage, Policy>::Collect::quadratic(Key key, Step<Key> step) const
+{
+  _candidates.push_back({ key, step, true });
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<typename Unsigned>
+bool Dictionary<Key, Monitor, Storage, Policy>::_admissible(Entry<Unsigned> key) const
+{
+  return key.value() <= _magnitude;
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<typename Unsigned>
+bool Dictionary<Key, Monitor, Storage, Policy>::_admissible(Fraction<Unsigned> key) const
 {
-  bool status = std::isnormal(key) && _graph.emplace(key, step).second;
+  return key.num() <= _magnitude && key.den() <= _magnitude && key.den() <= _denominator;
+}
+
+// Smooth keys are only expanded when pruning.
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<typename Unsigned>
+bool Dictionary<Key, Monitor, Storage, Policy>::_admissible(Smooth<Unsigned> key) const
+{
+  return (_magnitude == std::uintmax_t(-1) && _denominator == std::uintmax_t(-1)) || _admissible(key.fraction());
+}
+
+// Keys of other types bound their own magnitude.
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<typename Other>
+bool Dictionary<Key, Monitor, Storage, Policy>::_admissible(Other key) const
+{
+  return std::abs(key.log2()) <= Other::bits;
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+bool Dictionary<Key, Monitor, Storage, Policy>::_basic(Key key, Step<Key> step)
+{
+  bool normal = std::isnormal(key);
+  bool admissible = normal && _admissible(key);
+  bool status = admissible && (_dense.covers(key) ? _dense.emplace(key, step, level()) : _graph.emplace(key, step.at(level())).second);
 
-  if (status)
+  if (status) {
     _hierarchy.back().emplace_back(key);
+    _seen = _seen || (_watching && key == _watch);
+  }
 
+  _pruned += normal && !admissible;
+  _monitor.count(step.note(), status ? Outcome::inserted : admissible ? Outcome::duplicate : normal ? Outcome::pruned : Outcome::rejected);
   return status;
 }
 
-template<typename Key>
-void Dictionary<Key>::_quadratic(Key key, Step<Key> step)
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+void Dictionary<Key, Monitor, Storage, Policy>::_quadratic(Key key, Step<Key> step)
 {
-  while (_basic(key, step)) {
+  while (_basic(key, step) && Policy::allows(Operator::radical)) {
     step = { key, 's' };
     key = key.sqrt();
   }
 }
 
-template<typename Key>
-void Dictionary<Key>::_factorial()
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+void Dictionary<Key, Monitor, Storage, Policy>::_factorial()
 {
-  std::vector<Key>& destination = _hierarchy.back();
-  std::size_t length = destination.size();
+  Level& destination = _hierarchy.back();
+  std::size_t length = Policy::allows(Operator::factorial) ? destination.size() : 0;
 
   for (std::size_t k = 0; k < length; ++k) {
     Key x = destination[k];
@@ -137,27 +414,27 @@ void Dictionary<Key>::_factorial()
   }
 }
 
-template<typename Key>
-template<typename Unsigned>
-void Dictionary<Key>::_divides(Entry<Unsigned> x, Entry<Unsigned> y)
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<typename Sink, typename Unsigned>
+void Dictionary<Key, Monitor, Storage, Policy>::_divides(Sink sink, Entry<Unsigned> x, Entry<Unsigned> y)
 {
-  _quadratic(x / y, { x, y, '/' });
-  _quadratic(y / x, { y, x, '/' });
+  sink.quadratic(x / y, { x, y, '/' });
+  sink.quadratic(y / x, { y, x, '/' });
 }
 
-template<typename Key>
-template<typename Other>
-void Dictionary<Key>::_divides(Other x, Other y)
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<typename Sink, typename Other>
+void Dictionary<Key, Monitor, Storage, Policy>::_divides(Sink sink, Other x, Other y)
 {
   Other quotient = x / y;
 
-  _quadratic(quotient, { x, y, '/' });
-  _quadratic(quotient.inverse(), { y, x, '/' });
+  sink.quadratic(quotient, { x, y, '/' });
+  sink.quadratic(quotient.inverse(), { y, x, '/' });
 }
 
-template<typename Key>
-template<typename Unsigned>
-void Dictionary<Key>::_pow(Entry<Unsigned> x, Entry<Unsigned> y)
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<typename Sink, typename Unsigned>
+void Dictionary<Key, Monitor, Storage, Policy>::_pow(Sink sink, Entry<Unsigned> x, Entry<Unsigned> y)
 {
   if (x > 1 && y) {
     int shift = ctz(y.value());
@@ -169,10 +446,11 @@ void Dictionary<Key>::_pow(Entry<Unsigned> x, Entry<Unsigned> y)
     Entry<Unsigned> base = x.pow(odd);
     Entry<Unsigned> sqrt = base.sqrt();
 
-    _quadratic(sqrt, { x, y, {'^', shift + 1} });
+    if (Policy::allows(Operator::radical))
+      sink.quadratic(sqrt, { x, y, {'^', shift + 1} });
 
     while (shift >= 0 && base) {
-      _basic(base, { x, y, {'^', shift} });
+      sink.basic(base, { x, y, {'^', shift} });
 
       base *= base;
       --shift;
@@ -180,9 +458,9 @@ void Dictionary<Key>::_pow(Entry<Unsigned> x, Entry<Unsigned> y)
   }
 }
 
-template<typename Key>
-template<typename Unsigned>
-void Dictionary<Key>::_pow(Fraction<Unsigned> x, Fraction<Unsigned> y)
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<typename Sink, typename Unsigned>
+void Dictionary<Key, Monitor, Storage, Policy>::_pow(Sink sink, Fraction<Unsigned> x, Fraction<Unsigned> y)
 {
   if (y.den() == 1 && std::isnormal(x) && x.num() != x.den()) {
     int shift = ctz(y.num());
@@ -194,12 +472,14 @@ void Dictionary<Key>::_pow(Fraction<Unsigned> x, Fraction<Unsigned> y)
     Fraction<Unsigned> base = x.pow(odd);
     Fraction<Unsigned> sqrt = base.sqrt();
 
-    _quadratic(sqrt, { x, y, {'^', shift + 1} });
-    _quadratic(sqrt.inverse(), { x, y, {'^', ~(shift + 1)} });
+    if (Policy::allows(Operator::radical)) {
+      sink.quadratic(sqrt, { x, y, {'^', shift + 1} });
+      sink.quadratic(sqrt.inverse(), { x, y, {'^', ~(shift + 1)} });
+    }
 
     while (shift >= 0 && std::isnormal(base)) {
-      _basic(base, { x, y, {'^', shift} });
-      _basic(base.inverse(), { x, y, {'^', ~shift} });
+      sink.basic(base, { x, y, {'^', shift} });
+      sink.basic(base.inverse(), { x, y, {'^', ~shift} });
 
       base = base.square();
       --shift;
@@ -207,92 +487,832 @@ void Dictionary<Key>::_pow(Fraction<Unsigned> x, Fraction<Unsigned> y)
   }
 }
 
-template<typename Key>
-void Dictionary<Key>::_binary(Key x, Key y)
+// Powers of keys of other types, whose exponents are small integers
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<typename Sink, typename Other>
+void Dictionary<Key, Monitor, Storage, Policy>::_pow(Sink sink, Other x, Other y)
 {
-  _quadratic(x + y, { x, y, '+' });
-  _quadratic(x * y, { x, y, '*' });
+  std::uint64_t exponent = y.integer();
 
-  _quadratic(x - y, { x, y, '-' });
-  _quadratic(y - x, { y, x, '-' });
+  if (exponent && std::isnormal(x) && x.integer() != 1) {
+    int shift = ctz(exponent);
+    std::uint64_t odd = exponent >> shift;
 
-  _divides(x, y);
+    if (odd >= std::uint64_t(Other::bits))
+      return;
 
-  _pow(x, y);
-  _pow(y, x);
+    Other base = x.pow(odd);
+    Other sqrt = base.sqrt();
 
-  if (!(std::isnormal(x.factorial()) && std::isnormal(y.factorial()))) {
-    _quadratic(x.factorial(y), { x, y, {'!', '/'} });
-    _quadratic(y.factorial(x), { y, x, {'!', '/'} });
+    if (Policy::allows(Operator::radical)) {
+      sink.quadratic(sqrt, { x, y, {'^', shift + 1} });
+      sink.quadratic(sqrt.inverse(), { x, y, {'^', ~(shift + 1)} });
+    }
+
+    while (shift >= 0 && std::isnormal(base)) {
+      sink.basic(base, { x, y, {'^', shift} });
+      sink.basic(base.inverse(), { x, y, {'^', ~shift} });
+
+      base = base.square();
+      --shift;
+    }
+  }
+}
+
+// Integral levels are sorted once frozen, so that pairs whose product
+// overflows form a suffix of each row.
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<typename Unsigned, typename Allocator>
+void Dictionary<Key, Monitor, Storage, Policy>::_sort(std::vector<Entry<Unsigned>, Allocator>& level)
+{
+  std::sort(level.begin(), level.end());
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<typename Other>
+void Dictionary<Key, Monitor, Storage, Policy>::_sort(Other&)
+{}
+
+// Index of the first y in a sorted level such that x * y overflows.  Only
+// products and factorial quotients are skipped past it.  Powers of such a
+// pair can still fit under square roots, and sums rarely overflow.
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<typename Unsigned>
+std::size_t Dictionary<Key, Monitor, Storage, Policy>::_overflow(Entry<Unsigned> x, const Level& ys)
+{
+  return std::upper_bound(ys.begin(), ys.end(), Entry<Unsigned>(std::numeric_limits<Unsigned>::max() / x.value())) - ys.begin();
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<typename Other>
+std::size_t Dictionary<Key, Monitor, Storage, Policy>::_overflow(Other, const Level& ys)
+{
+  return ys.size();
+}
+
+// Sums and differences of the keys of both levels below a power of two, by
+// shifted unions of bitsets when that is cheaper than combining each pair.
+// One witness pair is then searched for every new key, so that steps are
+// the same as those of the pairwise sweep.
+//
+// The work is charged to the budget of the sweep, a pair for every 64 keys
+// filled, for every 4096 bits shifted, and for every sum or difference
+// checked.  It pauses when the budget runs out or the watched key is
+// inserted, and resumes from the cursor.  Return whether it is complete.
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<typename Unsigned, typename Allocator>
+bool Dictionary<Key, Monitor, Storage, Policy>::_sumset(const std::vector<Entry<Unsigned>, Allocator>& xs, const std::vector<Entry<Unsigned>, Allocator>& ys, std::size_t& budget)
+{
+  typedef Entry<Unsigned> Integer;
+
+  Sumset& s = _sums;
+
+  if (s.stage == Sumset::plan) {
+    s.stage = Sumset::done;
+
+    if (!(Policy::allows(Operator::addition) && Policy::allows(Operator::subtraction)))
+      return true;
+
+    double saving = 0;
+
+    // Each pair costs three lookups, and each word of a shift a small
+    // fraction of one.
+    for (int k = 12; k <= 26 && k < std::numeric_limits<Unsigned>::digits; ++k) {
+      std::size_t b = std::size_t(1) << k;
+      std::size_t mx = std::lower_bound(xs.begin(), xs.end(), Integer(b)) - xs.begin();
+      std::size_t my = std::lower_bound(ys.begin(), ys.end(), Integer(b)) - ys.begin();
+      double gain = 3.0 * mx * my - (2.0 * mx + my) * b / 1024 - 3.0 * b;
+
+      if (gain > saving) {
+        saving = gain;
+        s.bound = b;
+        s.nx = mx;
+        s.ny = my;
+      }
+    }
+
+    if (!s.bound)
+      return true;
+
+    s.left = Bitset(s.bound);
+    s.right = Bitset(s.bound);
+    s.sums = Bitset(2 * s.bound);
+    s.differences = Bitset(s.bound);
+    s.stage = Sumset::fill;
+    s.index = 0;
+  }
+
+  if (s.stage == Sumset::fill) {
+    for (; s.index < s.nx + s.ny; ++s.index) {
+      if (s.index % 64 == 0) {
+        if (!budget)
+          return false;
+
+        --budget;
+      }
+
+      if (s.index < s.nx)
+        s.left.insert(xs[s.index].value());
+      else
+        s.right.insert(ys[s.index - s.nx].value());
+    }
+
+    s.stage = Sumset::shift;
+    s.index = 0;
+  }
+
+  if (s.stage == Sumset::shift) {
+    const std::size_t cost = s.bound / 4096 + 1;
+
+    for (; s.index < s.nx + s.ny; ++s.index) {
+      if (!budget)
+        return false;
+
+      budget -= (std::min)(budget, cost);
+
+      if (s.index < s.nx) {
+        s.sums.shift_up(s.right, xs[s.index].value());
+        s.differences.shift_down(s.right, xs[s.index].value());
+      }
+      else {
+        s.differences.shift_down(s.left, ys[s.index - s.nx].value());
+      }
+    }
+
+    s.stage = Sumset::add;
+    s.index = 0;
+  }
+
+  if (s.stage == Sumset::add) {
+    for (s.index = s.sums.next(s.index); s.index < s.sums.bound(); s.index = s.sums.next(s.index + 1)) {
+      std::size_t v = s.index;
+      std::size_t i = 0;
+
+      if (!budget)
+        return false;
+
+      --budget;
+
+      if (_has(Integer(v)))
+        continue;
+
+      while (!s.right.contains(v - xs[i].value()))
+        ++i;
+
+      _quadratic(Integer(v), { xs[i], Integer(v - xs[i].value()), '+' });
+
+      if (_seen) {
+        ++s.index;
+        return false;
+      }
+    }
+
+    s.stage = Sumset::subtract;
+    s.index = 1;
+  }
+
+  if (s.stage == Sumset::subtract) {
+    for (s.index = s.differences.next(s.index); s.index < s.differences.bound(); s.index = s.differences.next(s.index + 1)) {
+      std::size_t v = s.index;
+
+      if (!budget)
+        return false;
+
+      --budget;
+
+      if (_has(Integer(v)))
+        continue;
+
+      for (std::size_t j = 0; j < s.ny; ++j) {
+        if (s.left.contains(ys[j].value() + v)) {
+          _quadratic(Integer(v), { Integer(ys[j].value() + v), ys[j], '-' });
+          v = 0;
+          break;
+        }
+      }
+
+      for (std::size_t i = 0; v && i < s.nx; ++i) {
+        if (s.right.contains(xs[i].value() + v)) {
+          _quadratic(Integer(v), { Integer(xs[i].value() + v), xs[i], '-' });
+          break;
+        }
+      }
+
+      if (_seen) {
+        ++s.index;
+        return false;
+      }
+    }
+
+    s.stage = Sumset::done;
+    s.left = Bitset();
+    s.right = Bitset();
+    s.sums = Bitset();
+    s.differences = Bitset();
+    _span = s.bound;
+  }
+
+  return true;
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<typename Other>
+bool Dictionary<Key, Monitor, Storage, Policy>::_sumset(const Other&, const Other&, std::size_t&)
+{
+  return true;
+}
+
+// Number of leading keys in a row whose sums and differences with x are
+// already found by _sumset
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<typename Unsigned>
+std::size_t Dictionary<Key, Monitor, Storage, Policy>::_covered(Entry<Unsigned> x, const Level& ys) const
+{
+  if (x.value() >= _span)
+    return 0;
+
+  return std::lower_bound(ys.begin(), ys.end(), Entry<Unsigned>(_span)) - ys.begin();
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<typename Other>
+std::size_t Dictionary<Key, Monitor, Storage, Policy>::_covered(Other, const Level&) const
+{
+  return 0;
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<typename Sink>
+void Dictionary<Key, Monitor, Storage, Policy>::_combine(Sink sink, Key x, Key y, bool product, bool additive)
+{
+  if (additive && Policy::allows(Operator::addition))
+    sink.quadratic(x + y, { x, y, '+' });
+
+  if (product && Policy::allows(Operator::multiplication))
+    sink.quadratic(x * y, { x, y, '*' });
+
+  if (additive && Policy::allows(Operator::subtraction)) {
+    sink.quadratic(x - y, { x, y, '-' });
+    sink.quadratic(y - x, { y, x, '-' });
+  }
+
+  if (Policy::allows(Operator::division))
+    _divides(sink, x, y);
+
+  if (Policy::allows(Operator::power)) {
+    _pow(sink, x, y);
+    _pow(sink, y, x);
+  }
+
+  if (product && Policy::allows(Operator::quotient) && !(std::isnormal(x.factorial()) && std::isnormal(y.factorial()))) {
+    sink.quadratic(x.factorial(y), { x, y, {'!', '/'} });
+    sink.quadratic(y.factorial(x), { y, x, {'!', '/'} });
   }
 }
 
-template<typename Key>
-void Dictionary<Key>::_neighbors(Key x, Key y)
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<typename Sink>
+void Dictionary<Key, Monitor, Storage, Policy>::_binary(Sink sink, Key x, Key y)
+{
+  _combine(sink, x, y, true, true);
+}
+
+// Combine a pair known to overflow in multiplication.  For x >= y, x! / y!
+// is then 1 if x = y, x if x = y + 1, or else above x * y, so the quotient
+// brings nothing new either.
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<typename Sink>
+void Dictionary<Key, Monitor, Storage, Policy>::_large(Sink sink, Key x, Key y)
+{
+  _combine(sink, x, y, false, true);
+}
+
+// Combine a pair whose sum and differences are found by _sumset
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<typename Sink>
+void Dictionary<Key, Monitor, Storage, Policy>::_small(Sink sink, Key x, Key y)
+{
+  _combine(sink, x, y, true, false);
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<typename Sink>
+void Dictionary<Key, Monitor, Storage, Policy>::_neighbors(Sink sink, Key x, Key y)
 {
   if (!(std::isnormal(x.factorial()) && std::isnormal(y.factorial()))) {
     Key ratio = x.factorial(y);
 
     if (std::isnormal(ratio)) {
-      _quadratic(ratio + Key(1), { x, y, {'!', '+'} });
-      _quadratic(ratio - Key(1), { x, y, {'!', '-'} });
+      sink.quadratic(ratio + Key(1), { x, y, {'!', '+'} });
+      sink.quadratic(ratio - Key(1), { x, y, {'!', '-'} });
     }
   }
 }
 
-template<typename Key>
-void Dictionary<Key>::grow()
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+void Dictionary<Key, Monitor, Storage, Policy>::cap(std::size_t memory)
+{
+  _memory = memory;
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+std::size_t Dictionary<Key, Monitor, Storage, Policy>::memory() const
+{
+  return _memory;
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+bool Dictionary<Key, Monitor, Storage, Policy>::full() const
+{
+  return _full;
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+void Dictionary<Key, Monitor, Storage, Policy>::prune(std::uintmax_t magnitude, std::uintmax_t denominator)
+{
+  _magnitude = magnitude;
+  _denominator = denominator;
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+std::size_t Dictionary<Key, Monitor, Storage, Policy>::pruned() const
+{
+  return _pruned;
+}
+
+// Hold integers below `bound` in a direct-indexed array instead of the
+// graph.  Call before growing.
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+void Dictionary<Key, Monitor, Storage, Policy>::dense(std::uintmax_t bound)
 {
-  _hierarchy.emplace_back();
+  _dense.resize(bound);
+}
 
+// The least positive integer below the dense bound that the dictionary
+// does not make yet, or 0 if there is none
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+std::uintmax_t Dictionary<Key, Monitor, Storage, Policy>::unreachable() const
+{
+  return _dense.unreachable();
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+std::size_t Dictionary<Key, Monitor, Storage, Policy>::predict() const
+{
   std::size_t size = level();
-  Key root(Concatenate, size, digit);
 
-  _quadratic(root, root);
+  if (size < 2)
+    return 16;
+
+  double last = _hierarchy[size - 1].size();
+  double previous = _hierarchy[size - 2].size();
+
+  return last * (std::max)(last / previous, 1.0);
+}
+
+// Predict the size, footprint and duration of the next level, or of the
+// level being grown.  The duration is that of combining an evenly spaced
+// sample of pairs and looking up their candidates, scaled to all pairs of
+// the level.  The size is extrapolated from the last two complete levels
+// like predict().  The sample overshoots it about twice by level 7, since
+// pairs often make the same key, so it only counts the keys of the first
+// levels, whose pairs it covers entirely.
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+Estimate Dictionary<Key, Monitor, Storage, Policy>::estimate(std::size_t samples)
+{
+  typedef std::chrono::steady_clock Clock;
+
+  struct Block
+  {
+    const Level* xs;
+    const Level* ys;
+    bool neighbors;
+    std::uint_fast64_t pairs;
+  };
+
+  std::size_t size = level() + !_growing;
+  std::vector<Block> blocks;
+  std::uint_fast64_t pairs = 0;
 
   for (std::size_t length = size / 2; length > 0; --length)
-    for (Key x: _hierarchy[length - 1])
-      for (Key y: _hierarchy[size - length - 1])
-        _binary(x, y);
+    blocks.push_back({ &_hierarchy[length - 1], &_hierarchy[size - length - 1], false, 0 });
+
+  if (size >= 3 && Policy::allows(Operator::neighbor))
+    blocks.push_back({ &_hierarchy[size - 3], &_hierarchy[0], true, 0 });
+
+  for (Block& block: blocks)
+    pairs += block.pairs = std::uint_fast64_t(block.xs->size()) * block.ys->size();
+
+  std::size_t count = (std::min)(std::uint_fast64_t(samples), pairs);
+  std::vector<Candidate> buffer;
+  std::unordered_set<Key> fresh;
+  Clock::time_point start = Clock::now();
+
+  for (std::size_t k = 0; k < count; ++k) {
+    std::uint_fast64_t index = pairs / count * k + pairs % count * k / count;
+    const Block* block = blocks.data();
+
+    for (; index >= block->pairs; ++block)
+      index -= block->pairs;
+
+    Key x = (*block->xs)[index / block->ys->size()];
+    Key y = (*block->ys)[index % block->ys->size()];
+
+    if (block->neighbors)
+      _neighbors(Collect(buffer), x, y);
+    else
+      _binary(Collect(buffer), x, y);
+  }
+
+  for (const Candidate& candidate: buffer) {
+    for (Key key = candidate.key; std::isnormal(key) && _admissible(key) && !_has(key); key = key.sqrt())
+      if (size >= 3 || !fresh.insert(key).second || !candidate.quadratic)
+        break;
+  }
+
+  double scale = count ? double(pairs) / count : 0;
+  double seconds = std::chrono::duration<double>(Clock::now() - start).count() * scale;
+  std::size_t made = _growing ? _hierarchy.back().size() : 1;
+  std::size_t keys = made + fresh.size() * scale;
+
+  if (size >= 3) {
+    double last = _hierarchy[size - 2].size();
+    double previous = _hierarchy[size - 3].size();
+
+    keys = (std::max)(std::size_t(last * (std::max)(last / previous, 1.0)), _growing ? made : 0);
+  }
+
+  return { keys, bytes(keys - (_growing ? made : 0)), _growing ? seconds * (1 - progress()) : seconds };
+}
+
+// Bytes held by the dictionary, or that it would hold with `extra` more keys.
+// The graph and the levels are charged the memory their storage has mapped if
+// that exceeds their footprint, since an arena keeps what they free.
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+std::size_t Dictionary<Key, Monitor, Storage, Policy>::bytes(std::size_t extra) const
+{
+  std::size_t containers = (std::max)(footprint(_graph) + footprint(_hierarchy), _storage.bytes());
+  std::size_t filters = _reachable.bytes();
+
+  for (const Filter<Key>& filter: _filters)
+    filters += filter.bytes();
+
+  return containers + footprint(_graph, extra) - footprint(_graph) + filters + _dense.bytes() + extra * sizeof(Key);
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+void Dictionary<Key, Monitor, Storage, Policy>::_open()
+{
+  std::size_t predicted = predict();
+
+  _graph.reserve(_graph.size() + predicted);
+  _hierarchy.emplace_back(_storage.template allocator<Key>());
+  _hierarchy.back().reserve(predicted);
+
+  std::size_t size = level();
+  Key root(Concatenate, size, digit);
+
+  _monitor.level(size);
+  if (size == 1 || Policy::allows(Operator::concatenation))
+    _quadratic(root, root);
+
+  _growing = true;
+  _length = size / 2;
+  _first = 0;
+  _second = 0;
+  _pairs = size >= 3 && Policy::allows(Operator::neighbor) ? _hierarchy[size - 3].size() * _hierarchy[0].size() : 0;
+  _done = 0;
+
+  for (std::size_t length = _length; length > 0; --length)
+    _pairs += _hierarchy[length - 1].size() * _hierarchy[size - length - 1].size();
+
+  if (_watching && !_seen)
+    _probe();
+}
+
+// Before the sweep, pair each key with the operands that would give the
+// watched key, or its square, in one operation.
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+void Dictionary<Key, Monitor, Storage, Policy>::_probe()
+{
+  std::size_t size = level();
+  const Key targets[] = { _watch, _watch * _watch };
+
+  for (Key target: targets) {
+    for (std::size_t length = 1; length < size; ++length) {
+      for (Key x: _hierarchy[length - 1]) {
+        const Key operands[] = { target - x, x - target, target + x, target / x, x / target, target * x };
+
+        for (Key y: operands) {
+          if (std::isnormal(y) && _maybe(_filters[size - length - 1], y) && _has(y) && digits(y) == size - length) {
+            _binary(Insert(*this), x, y);
+
+            if (_seen)
+              return;
+          }
+        }
+      }
+    }
+  }
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+template<void (*combine)(typename Dictionary<Key, Monitor, Storage, Policy>::Insert, Key, Key)>
+bool Dictionary<Key, Monitor, Storage, Policy>::_sweep(const Level& xs, const Level& ys, std::size_t& budget)
+{
+  if (combine == &Dictionary::_binary<Insert> && !_sumset(xs, ys, budget))
+    return false;
+
+  std::size_t start = budget;
+  std::size_t j = _second;
+
+  for (std::size_t i = _first; i < xs.size(); ++i, j = 0) {
+    std::size_t split = combine == &Dictionary::_binary<Insert> ? _overflow(xs[i], ys) : ys.size();
+    std::size_t covered = combine == &Dictionary::_binary<Insert> ? _covered(xs[i], ys) : 0;
+
+    for (; j < ys.size(); ++j) {
+      if (!budget) {
+        _first = i;
+        _second = j;
+        _done += start;
+        return false;
+      }
+
+      --budget;
+      (j < covered ? &Dictionary::_small<Insert> : j < split ? combine : &Dictionary::_large<Insert>)(Insert(*this), xs[i], ys[j]);
+
+      if (_seen) {
+        _first = i;
+        _second = j + 1;
+        _done += start - budget;
+        return false;
+      }
+    }
+  }
+
+  _first = 0;
+  _second = 0;
+  _span = 0;
+  _sums = Sumset();
+  _done += start - budget;
+  return true;
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+void Dictionary<Key, Monitor, Storage, Policy>::grow()
+{
+  grow_some(-1);
+}
+
+// Grow the current level by at most `budget` pairs of keys, opening a new
+// level if none is in progress.  Return whether the level is complete.  A
+// watched key pauses the level as soon as it is inserted.
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+bool Dictionary<Key, Monitor, Storage, Policy>::grow_some(std::size_t budget)
+{
+  _seen = false;
+
+  if (!_growing)
+    _open();
+
+  if (_seen) {
+    _monitor.finish(_graph, _hierarchy);
+    return false;
+  }
 
-  if (size >= 3)
-    for (Key x: _hierarchy[size - 3])
-      for (Key y: _hierarchy[0])
-        _neighbors(x, y);
+  std::size_t size = level();
+
+  for (; _length > 0; --_length) {
+    _monitor.start(Phase::pairs, _length);
+    bool complete = _sweep<&Dictionary::_binary<Insert>>(_hierarchy[_length - 1], _hierarchy[size - _length - 1], budget);
+    _monitor.stop(Phase::pairs, _length);
+
+    if (_seen)
+      _monitor.finish(_graph, _hierarchy);
+
+    if (!complete)
+      return false;
+  }
 
+  if (size >= 3 && Policy::allows(Operator::neighbor)) {
+    _monitor.start(Phase::neighbors, size);
+    bool complete = _sweep<&Dictionary::_neighbors<Insert>>(_hierarchy[size - 3], _hierarchy[0], budget);
+    _monitor.stop(Phase::neighbors, size);
+
+    if (_seen)
+      _monitor.finish(_graph, _hierarchy);
+
+    if (!complete)
+      return false;
+  }
+
+  _monitor.start(Phase::factorial, size);
   _factorial();
+  _monitor.stop(Phase::factorial, size);
+  _monitor.finish(_graph, _hierarchy);
+  _freeze();
+
+  _growing = false;
+  return true;
 }
 
-template<typename Key>
-bool Dictionary<Key>::build(Key key, std::size_t limit)
+// Sort the completed level, summarize it, and rebuild the filter of all
+// levels
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+void Dictionary<Key, Monitor, Storage, Policy>::_freeze()
 {
-  while (_hierarchy.size() < limit) {
-    auto found = _graph.find(key);
+  _sort(_hierarchy.back());
+  _filters.emplace_back(_hierarchy.back().size());
+  _reachable = Filter<Key>(_graph.size());
 
-    if (found != _graph.end())
-      return true;
+  for (Key key: _hierarchy.back())
+    _filters.back().insert(key);
+
+  for (const auto& pair: _graph)
+    _reachable.insert(pair.first);
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+bool Dictionary<Key, Monitor, Storage, Policy>::_has(Key key) const
+{
+  return _dense.covers(key) ? _dense.digits(key) : _graph.count(key);
+}
+
+// Query a filter, reporting the probes of the graph it saves to the monitor
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+bool Dictionary<Key, Monitor, Storage, Policy>::_maybe(const Filter<Key>& filter, Key key) const
+{
+  bool maybe = filter.contains(key);
+
+  _monitor.probe(maybe);
+  return maybe;
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+bool Dictionary<Key, Monitor, Storage, Policy>::growing() const
+{
+  return _growing;
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+double Dictionary<Key, Monitor, Storage, Policy>::progress() const
+{
+  return _growing && _pairs ? double(_done) / _pairs : 1;
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+void Dictionary<Key, Monitor, Storage, Policy>::watch(Key key)
+{
+  _watch = key;
+  _watching = true;
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+void Dictionary<Key, Monitor, Storage, Policy>::unwatch()
+{
+  _watching = false;
+}
+
+// Grow until the key is found or `limit` levels are complete, finishing a
+// level left partial by grow_some().  Return whether the key takes fewer than
+// `limit` digits, which does not depend on how the levels were sliced.
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+bool Dictionary<Key, Monitor, Storage, Policy>::build(Key key, std::size_t limit)
+{
+  if (!_admissible(key))
+    return false;
+
+  bool found = false;
+
+  watch(key);
+
+  for (;;) {
+    found = _has(key);
+
+    if (found || (!_growing && _hierarchy.size() >= limit))
+      break;
+
+    if (!_growing && bytes(predict()) > _memory) {
+      _full = true;
+      break;
+    }
 
     grow();
   }
 
-  return false;
+  unwatch();
+  return found && digits(key) < limit;
 }
 
-template<typename Key>
-std::size_t Dictionary<Key>::level() const
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+std::size_t Dictionary<Key, Monitor, Storage, Policy>::level() const
 {
   return _hierarchy.size();
 }
 
-template<typename Key>
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+std::size_t Dictionary<Key, Monitor, Storage, Policy>::digits(Key key) const
+{
+  if (_dense.covers(key))
+    return _dense.digits(key);
+
+  auto found = _graph.find(key);
+  return found == _graph.end() ? 0 : found->second.digits();
+}
+
+// Whether the key is in the dictionary.  Keys absent from every completed
+// level are mostly rejected by a filter without probing the graph.
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+bool Dictionary<Key, Monitor, Storage, Policy>::contains(Key key) const
+{
+  if (!std::isnormal(key))
+    return false;
+
+  if (_dense.covers(key))
+    return _dense.digits(key);
+
+  if (!_growing && !_maybe(_reachable, key))
+    return false;
+
+  bool found = _graph.count(key);
+
+  if (!_growing && !found)
+    _monitor.positive();
+
+  return found;
+}
+
+// Whether the key is made of at most `digits` digits in the dictionary
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+bool Dictionary<Key, Monitor, Storage, Policy>::reachable(Key key, std::size_t digits) const
+{
+  if (!std::isnormal(key))
+    return false;
+
+  if (_dense.covers(key)) {
+    std::size_t found = _dense.digits(key);
+    return found && found <= digits;
+  }
+
+  std::size_t frozen = _filters.size();
+  bool filtered = digits <= frozen;
+  bool maybe = !filtered;
+
+  if (filtered && digits == frozen)
+    maybe = _maybe(_reachable, key);
+
+  if (filtered && digits < frozen) {
+    for (std::size_t length = 0; !maybe && length < digits; ++length)
+      maybe = _filters[length].contains(key);
+
+    _monitor.probe(maybe);
+  }
+
+  if (!maybe)
+    return false;
+
+  std::size_t found = this->digits(key);
+  bool hit = found && found <= digits;
+
+  if (filtered && !hit)
+    _monitor.positive();
+
+  return hit;
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+Step<Key> Dictionary<Key, Monitor, Storage, Policy>::step(Key key) const
+{
+  return _dense.covers(key) ? _dense.at(key) : _graph.at(key);
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+const typename Dictionary<Key, Monitor, Storage, Policy>::Level& Dictionary<Key, Monitor, Storage, Policy>::operator[](std::size_t index) const
+{
+  return _hierarchy[index];
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+const Storage& Dictionary<Key, Monitor, Storage, Policy>::storage() const
+{
+  return _storage;
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+const Monitor& Dictionary<Key, Monitor, Storage, Policy>::monitor() const
+{
+  return _monitor;
+}
+
+template<typename Key, typename Monitor, typename Storage, typename Policy>
 template<typename Container, typename Function>
-Function Dictionary<Key>::bfs(Key key, Function f) const
+Function Dictionary<Key, Monitor, Storage, Policy>::bfs(Key key, Function f) const
 {
   Container container = { key };
 
   for (std::queue<Key, Container> queue(container); !queue.empty(); queue.pop()) {
     key = queue.front();
-    Step<Key> step = _graph.at(key);
+    Step<Key> step = this->step(key);
 
     if (step.note().base()) {
       f(key, step);
@@ -306,22 +1326,22 @@ Function Dictionary<Key>::bfs(Key key, Function f) const
   return f;
 }
 
-template<typename Key>
+template<typename Key, typename Monitor, typename Storage, typename Policy>
 template<typename Function>
-Function Dictionary<Key>::bfs(Key key, Function f) const
+Function Dictionary<Key, Monitor, Storage, Policy>::bfs(Key key, Function f) const
 {
   return bfs<std::deque<Key>>(key, f);
 }
 
-template<typename Key>
+template<typename Key, typename Monitor, typename Storage, typename Policy>
 template<typename Container, typename Function>
-Function Dictionary<Key>::dfs(Key key, Function f) const
+Function Dictionary<Key, Monitor, Storage, Policy>::dfs(Key key, Function f) const
 {
   Container container = { key };
 
   for (std::stack<Key, Container> stack(container); !stack.empty(); stack.pop()) {
     key = stack.top();
-    Step<Key> step = _graph.at(key);
+    Step<Key> step = this->step(key);
 
     if (step.note().base()) {
       if (step.second())
@@ -335,9 +1355,9 @@ Function Dictionary<Key>::dfs(Key key, Function f) const
   return f;
 }
 
-template<typename Key>
+template<typename Key, typename Monitor, typename Storage, typename Policy>
 template<typename Function>
-Function Dictionary<Key>::dfs(Key key, Function f) const
+Function Dictionary<Key, Monitor, Storage, Policy>::dfs(Key key, Function f) const
 {
   return dfs<std::vector<Key>>(key, f);
 }
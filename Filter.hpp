@@ -0,0 +1,105 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_FILTER_HPP
+#define CHIC_FILTER_HPP
+
+#include <functional>
+#include <vector>
+#include <cstdint>
+
+namespace Chic {
+
+// Blocked Bloom filter.  Each key sets `hashes` bits within one block of a
+// cache line, so a query touches a single line.  With the default ten bits
+// per key, about one in a hundred absent keys is reported present.
+template<typename Key>
+class Filter
+{
+  private:
+    static const int words = 8;
+    static const int hashes = 6;
+
+    std::vector<std::uint64_t> _bits;
+    std::size_t _blocks;
+
+    static std::uint64_t _mix(Key);
+
+  public:
+    explicit Filter(std::size_t keys = 0, std::size_t bits = 10);
+
+    void insert(Key);
+    bool contains(Key) const;
+    std::size_t bytes() const;
+};
+
+template<typename Key>
+std::uint64_t Filter<Key>::_mix(Key key)
+{
+  std::uint64_t hash = std::hash<Key>()(key) + 0x9e3779b97f4a7c15;
+
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccd;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53;
+  hash ^= hash >> 33;
+
+  return hash;
+}
+
+template<typename Key>
+Filter<Key>::Filter(std::size_t keys, std::size_t bits)
+  : _bits(words * ((keys * bits + 64 * words - 1) / (64 * words) + 1)),
+    _blocks(_bits.size() / words)
+{}
+
+template<typename Key>
+void Filter<Key>::insert(Key key)
+{
+  std::uint64_t hash = _mix(key);
+  std::uint64_t* block = &_bits[words * (hash % _blocks)];
+
+  hash = hash / _blocks * 0x9e3779b97f4a7c15;
+
+  for (int k = 0; k < hashes; ++k, hash >>= 9)
+    block[hash >> 6 & (words - 1)] |= std::uint64_t(1) << (hash & 63);
+}
+
+template<typename Key>
+bool Filter<Key>::contains(Key key) const
+{
+  std::uint64_t hash = _mix(key);
+  const std::uint64_t* block = &_bits[words * (hash % _blocks)];
+  bool present = true;
+
+  hash = hash / _blocks * 0x9e3779b97f4a7c15;
+
+  for (int k = 0; k < hashes; ++k, hash >>= 9)
+    present = present && block[hash >> 6 & (words - 1)] >> (hash & 63) & 1;
+
+  return present;
+}
+
+template<typename Key>
+std::size_t Filter<Key>::bytes() const
+{
+  return _bits.capacity() * sizeof(std::uint64_t);
+}
+
+} // namespace Chic
+
+#endif // CHIC_FILTER_HPP
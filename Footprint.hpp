@@ -0,0 +1,57 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_FOOTPRINT_HPP
+#define CHIC_FOOTPRINT_HPP
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+namespace Chic {
+
+// Approximate heap usage of the standard containers behind Dictionary, with
+// every node counted as a separate allocation of a forward link, a cached
+// hash, and the value, rounded up to the malloc granularity
+//
+// The hash table can be measured as if it held extra keys, which accounts
+// for the buckets it would rehash into.
+template<typename Key, typename Value, typename... Rest>
+std::size_t footprint(const std::unordered_map<Key, Value, Rest...>& map, std::size_t extra = 0)
+{
+  const std::size_t node = (2 * sizeof(void*) + sizeof(std::size_t) + sizeof(std::pair<const Key, Value>) + 15) & ~std::size_t(15);
+
+  std::size_t size = map.size() + extra;
+  std::size_t buckets = (std::max)(map.bucket_count(), std::size_t(size / map.max_load_factor()));
+
+  return buckets * sizeof(void*) + size * node;
+}
+
+template<typename Key, typename... Inner, typename... Outer>
+std::size_t footprint(const std::vector<std::vector<Key, Inner...>, Outer...>& hierarchy)
+{
+  std::size_t bytes = hierarchy.capacity() * sizeof(std::vector<Key, Inner...>);
+
+  for (const std::vector<Key, Inner...>& level: hierarchy)
+    bytes += level.capacity() * sizeof(Key);
+
+  return bytes;
+}
+
+} // namespace Chic
+
+#endif // CHIC_FOOTPRINT_HPP
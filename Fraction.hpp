@@ -33,6 +33,7 @@ class Fraction : public Arithmetic<Fraction<Unsigned>>
     Fraction& operator++();
     Fraction& operator--();
     Fraction& _apply(Fraction);
+    Fraction& _reduce();
 
   public:
     enum class Canonical_t {};
@@ -224,6 +225,21 @@ Fraction<Unsigned> Fraction<Unsigned>::pow(Fraction exponent) const
   return nan();
 }
 
+// Divide out the common factor left by addition or subtraction.  Infinity
+// and NaN have a zero denominator and are left alone.
+template<typename Unsigned>
+Fraction<Unsigned>& Fraction<Unsigned>::_reduce()
+{
+  if (den()) {
+    Unsigned divisor = gcd(num(), den());
+
+    _num = num() / divisor;
+    _den = den() / divisor;
+  }
+
+  return *this;
+}
+
 template<typename Unsigned>
 Fraction<Unsigned>& Fraction<Unsigned>::operator+=(Fraction other)
 {
@@ -239,7 +255,7 @@ Fraction<Unsigned>& Fraction<Unsigned>::operator+=(Fraction other)
     _num = _num | (overflow && !_num);
   }
 
-  return *this;
+  return _reduce();
 }
 
 template<typename Unsigned>
@@ -252,7 +268,7 @@ Fraction<Unsigned>& Fraction<Unsigned>::operator-=(Fraction other)
   _num *= !invalid;
   _den *= !invalid;
 
-  return *this;
+  return _reduce();
 }
 
 template<typename Unsigned>
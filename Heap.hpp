@@ -0,0 +1,54 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_HEAP_HPP
+#define CHIC_HEAP_HPP
+
+#include <memory>
+
+namespace Chic {
+
+// Storage of Dictionary from the general-purpose heap
+class Heap
+{
+  public:
+    template<typename T>
+    using Allocator = std::allocator<T>;
+
+    template<typename T>
+    Allocator<T> allocator() const;
+
+    std::size_t bytes() const;
+};
+
+template<typename T>
+Heap::Allocator<T> Heap::allocator() const
+{
+  return Allocator<T>();
+}
+
+// Memory mapped by the storage itself, none for the heap, where containers
+// return what they free
+inline
+std::size_t Heap::bytes() const
+{
+  return 0;
+}
+
+} // namespace Chic
+
+#endif // CHIC_HEAP_HPP
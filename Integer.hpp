@@ -58,6 +58,24 @@ int ctz(unsigned long long x)
   return __builtin_ctzll(x);
 }
 
+inline
+int clz(unsigned int x)
+{
+  return __builtin_clz(x);
+}
+
+inline
+int clz(unsigned long x)
+{
+  return __builtin_clzl(x);
+}
+
+inline
+int clz(unsigned long long x)
+{
+  return __builtin_clzll(x);
+}
+
 #endif // __GNUC__
 
 template<typename Unsigned>
@@ -68,6 +86,17 @@ int ctz(Unsigned x)
   return bitset.count();
 }
 
+template<typename Unsigned>
+int clz(Unsigned x)
+{
+  int count = std::numeric_limits<Unsigned>::digits;
+
+  for (; x; x >>= 1)
+    --count;
+
+  return count;
+}
+
 #ifdef __BMI__
 
 template<typename Unsigned>
@@ -0,0 +1,326 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_LANES_HPP
+#define CHIC_LANES_HPP
+
+#include "Entry.hpp"
+#include "Step.hpp"
+#include <unordered_map>
+#include <vector>
+
+namespace Chic {
+
+// Experimental engine that grows the integral dictionaries of all nine
+// digits together.  A row holds the value of one expression shape for every
+// digit, one lane per digit, and its mask tells in which lanes the value is
+// new.  Candidates are computed for all lanes at once in fixed-width loops
+// the compiler can vectorize, while deduplication stays per digit.
+template<typename Unsigned>
+class Lanes
+{
+  public:
+    typedef Entry<Unsigned> Key;
+    static const int width = 9;
+
+    struct Row
+    {
+      Unsigned value[width];
+      unsigned mask;
+    };
+
+  private:
+    typedef Annotation<char> Note;
+
+    std::unordered_map<Key, Step<Key>> _graphs[width];
+    std::vector<std::vector<Row>> _hierarchy;
+
+    unsigned _basic(Row, const Row&, const Row&, const Note*);
+    void _quadratic(Row, const Row&, const Row&, const Note*);
+    void _quadratic(Row, const Row&, const Row&, Note);
+    void _factorial();
+
+    void _pow(const Row&, const Row&, unsigned);
+    void _binary(const Row&, const Row&);
+    void _neighbors(const Row&, const Row&);
+
+  public:
+    void grow();
+    std::size_t level() const;
+    std::size_t size(int digit, std::size_t level) const;
+    const std::vector<Row>& operator[](std::size_t) const;
+    const std::unordered_map<Key, Step<Key>>& graph(int digit) const;
+};
+
+template<typename Unsigned>
+unsigned Lanes<Unsigned>::_basic(Row candidate, const Row& first, const Row& second, const Note* notes)
+{
+  unsigned mask = 0;
+
+  for (int k = 0; k < width; ++k)
+    if (candidate.mask >> k & 1 && candidate.value[k])
+      mask |= unsigned(_graphs[k].emplace(candidate.value[k], Step<Key>(first.value[k], second.value[k], notes[k])).second) << k;
+
+  if (mask) {
+    candidate.mask = mask;
+    _hierarchy.back().push_back(candidate);
+  }
+
+  return mask;
+}
+
+template<typename Unsigned>
+void Lanes<Unsigned>::_quadratic(Row candidate, const Row& first, const Row& second, const Note* notes)
+{
+  static const Row none = {};
+  static const Note radicals[width] = { 's', 's', 's', 's', 's', 's', 's', 's', 's' };
+
+  candidate.mask = _basic(candidate, first, second, notes);
+
+  while (candidate.mask) {
+    Row previous = candidate;
+
+    for (int k = 0; k < width; ++k)
+      candidate.value[k] = Key(previous.value[k]).sqrt();
+
+    candidate.mask = _basic(candidate, previous, none, radicals);
+  }
+}
+
+template<typename Unsigned>
+void Lanes<Unsigned>::_quadratic(Row candidate, const Row& first, const Row& second, Note note)
+{
+  const Note notes[width] = { note, note, note, note, note, note, note, note, note };
+  _quadratic(candidate, first, second, notes);
+}
+
+template<typename Unsigned>
+void Lanes<Unsigned>::_factorial()
+{
+  static const Row none = {};
+  static const Note factorials[width] = { '!', '!', '!', '!', '!', '!', '!', '!', '!' };
+
+  std::size_t length = _hierarchy.back().size();
+
+  for (std::size_t index = 0; index < length; ++index) {
+    Row x = _hierarchy.back()[index];
+    Row y = x;
+
+    for (int k = 0; k < width; ++k)
+      y.value[k] = Key(x.value[k]).factorial();
+
+    while ((y.mask = _basic(y, x, none, factorials))) {
+      x = y;
+
+      for (int k = 0; k < width; ++k)
+        y.value[k] = Key(x.value[k]).factorial();
+    }
+  }
+}
+
+template<typename Unsigned>
+void Lanes<Unsigned>::_pow(const Row& x, const Row& y, unsigned mask)
+{
+  Row base = {};
+  Row sqrt = {};
+  Note notes[width];
+  int shift[width] = {};
+
+  for (int k = 0; k < width; ++k) {
+    if (mask >> k & 1 && x.value[k] > 1 && y.value[k]) {
+      shift[k] = ctz(y.value[k]);
+      Unsigned odd = y.value[k] >> shift[k];
+
+      if (odd < std::numeric_limits<Unsigned>::digits) {
+        base.value[k] = Key(x.value[k]).pow(odd);
+        sqrt.value[k] = Key(base.value[k]).sqrt();
+        sqrt.mask |= 1u << k;
+        notes[k] = { '^', shift[k] + 1 };
+      }
+    }
+  }
+
+  if (!sqrt.mask)
+    return;
+
+  _quadratic(sqrt, x, y, notes);
+
+  for (int k = 0; k < width; ++k)
+    base.mask |= unsigned(sqrt.mask >> k & 1 && base.value[k]) << k;
+
+  while (base.mask) {
+    for (int k = 0; k < width; ++k)
+      notes[k] = { '^', shift[k] };
+
+    _basic(base, x, y, notes);
+
+    for (int k = 0; k < width; ++k) {
+      base.value[k] = Key(base.value[k]) * Key(base.value[k]);
+      base.mask &= ~(unsigned(--shift[k] < 0 || !base.value[k]) << k);
+    }
+  }
+}
+
+template<typename Unsigned>
+void Lanes<Unsigned>::_binary(const Row& x, const Row& y)
+{
+  unsigned mask = x.mask & y.mask;
+
+  if (!mask)
+    return;
+
+  Row sum, product, difference, reverse, quotient, inverse;
+  Row falling = {};
+  Row rising = {};
+
+  sum.mask = product.mask = difference.mask = reverse.mask = quotient.mask = inverse.mask = mask;
+
+  for (int k = 0; k < width; ++k) {
+    Unsigned a = x.value[k];
+    Unsigned b = y.value[k];
+    Unsigned s = a + b;
+    Unsigned q = b ? a / b : 0;
+    Unsigned r = a ? b / a : 0;
+
+    sum.value[k] = s * (s >= a);
+    difference.value[k] = (a - b) * (a > b);
+    reverse.value[k] = (b - a) * (b > a);
+    quotient.value[k] = q * (q * b == a);
+    inverse.value[k] = r * (r * a == b);
+  }
+
+  for (int k = 0; k < width; ++k)
+    product.value[k] = Key(x.value[k]) * Key(y.value[k]);
+
+  _quadratic(sum, x, y, '+');
+  _quadratic(product, x, y, '*');
+
+  _quadratic(difference, x, y, '-');
+  _quadratic(reverse, y, x, '-');
+
+  _quadratic(quotient, x, y, '/');
+  _quadratic(inverse, y, x, '/');
+
+  _pow(x, y, mask);
+  _pow(y, x, mask);
+
+  for (int k = 0; k < width; ++k) {
+    Key a = x.value[k];
+    Key b = y.value[k];
+
+    if (mask >> k & 1 && !(a.factorial() && b.factorial())) {
+      falling.value[k] = a.factorial(b);
+      rising.value[k] = b.factorial(a);
+      falling.mask |= 1u << k;
+    }
+  }
+
+  rising.mask = falling.mask;
+
+  _quadratic(falling, x, y, { '!', '/' });
+  _quadratic(rising, y, x, { '!', '/' });
+}
+
+template<typename Unsigned>
+void Lanes<Unsigned>::_neighbors(const Row& x, const Row& y)
+{
+  unsigned mask = x.mask & y.mask;
+  Row successor = {};
+  Row predecessor = {};
+
+  for (int k = 0; k < width; ++k) {
+    Key a = x.value[k];
+    Key b = y.value[k];
+
+    if (mask >> k & 1 && !(a.factorial() && b.factorial())) {
+      Key ratio = a.factorial(b);
+
+      if (ratio) {
+        successor.value[k] = ratio + Key(1);
+        predecessor.value[k] = ratio - Key(1);
+        successor.mask |= 1u << k;
+      }
+    }
+  }
+
+  predecessor.mask = successor.mask;
+
+  _quadratic(successor, x, y, { '!', '+' });
+  _quadratic(predecessor, x, y, { '!', '-' });
+}
+
+template<typename Unsigned>
+void Lanes<Unsigned>::grow()
+{
+  static const Row none = {};
+
+  _hierarchy.emplace_back();
+
+  std::size_t size = level();
+  Row root;
+
+  for (int k = 0; k < width; ++k)
+    root.value[k] = concatenate<Unsigned>(size, k + 1);
+
+  root.mask = (1u << width) - 1;
+  _quadratic(root, root, none, Note());
+
+  for (std::size_t length = size / 2; length > 0; --length)
+    for (const Row& x: _hierarchy[length - 1])
+      for (const Row& y: _hierarchy[size - length - 1])
+        _binary(x, y);
+
+  if (size >= 3)
+    for (const Row& x: _hierarchy[size - 3])
+      for (const Row& y: _hierarchy[0])
+        _neighbors(x, y);
+
+  _factorial();
+}
+
+template<typename Unsigned>
+std::size_t Lanes<Unsigned>::level() const
+{
+  return _hierarchy.size();
+}
+
+template<typename Unsigned>
+std::size_t Lanes<Unsigned>::size(int digit, std::size_t level) const
+{
+  std::size_t count = 0;
+
+  for (const Row& row: _hierarchy[level])
+    count += row.mask >> (digit - 1) & 1;
+
+  return count;
+}
+
+template<typename Unsigned>
+const std::vector<typename Lanes<Unsigned>::Row>& Lanes<Unsigned>::operator[](std::size_t index) const
+{
+  return _hierarchy[index];
+}
+
+template<typename Unsigned>
+const std::unordered_map<typename Lanes<Unsigned>::Key, Step<typename Lanes<Unsigned>::Key>>& Lanes<Unsigned>::graph(int digit) const
+{
+  return _graphs[digit - 1];
+}
+
+} // namespace Chic
+
+#endif // CHIC_LANES_HPP
@@ -0,0 +1,91 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_MONITOR_HPP
+#define CHIC_MONITOR_HPP
+
+#include "Annotation.hpp"
+#include <cstddef>
+
+namespace Chic {
+
+enum class Phase { pairs, neighbors, factorial };
+enum class Outcome { rejected, pruned, duplicate, inserted };
+
+enum class Operator
+{
+  concatenation,
+  addition,
+  subtraction,
+  multiplication,
+  division,
+  power,
+  factorial,
+  quotient,
+  neighbor,
+  radical
+};
+
+const int operators = int(Operator::radical) + 1;
+
+inline
+Operator classify(Annotation<char> note)
+{
+  switch (note.base()) {
+    case '\0': return Operator::concatenation;
+    case '+': return Operator::addition;
+    case '-': return Operator::subtraction;
+    case '*': return Operator::multiplication;
+    case '/': return Operator::division;
+    case '^': return Operator::power;
+    case 's': return Operator::radical;
+  }
+
+  switch (note.code()) {
+    case '\0': return Operator::factorial;
+    case '/': return Operator::quotient;
+  }
+
+  return Operator::neighbor;
+}
+
+inline
+const char* symbol(Operator op)
+{
+  static const char* const table[operators] = { "root", "+", "-", "*", "/", "^", "!", "!/", "!+-", "s" };
+
+  return table[int(op)];
+}
+
+// The default monitor of Dictionary, which records nothing.  The lookup
+// hooks are const because const lookups of the dictionary call them.
+struct Silent
+{
+  void level(std::size_t) {}
+  void start(Phase, std::size_t) {}
+  void stop(Phase, std::size_t) {}
+  void count(Annotation<char>, Outcome) {}
+  void probe(bool) const {}
+  void positive() const {}
+
+  template<typename Graph, typename Hierarchy>
+  void finish(const Graph&, const Hierarchy&) {}
+};
+
+} // namespace Chic
+
+#endif // CHIC_MONITOR_HPP
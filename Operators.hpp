@@ -0,0 +1,53 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_OPERATORS_HPP
+#define CHIC_OPERATORS_HPP
+
+#include "Monitor.hpp"
+
+namespace Chic {
+
+constexpr unsigned mask(Operator);
+
+// All operators of Tchisla
+const unsigned tchisla = (1u << operators) - 1;
+
+// Policy of the operators a dictionary generates.  The set is fixed at
+// compile time, so branches of disallowed operators vanish from the sweeps.
+// Concatenation is always allowed for the single digit, which roots every
+// dictionary.
+template<unsigned Mask = tchisla>
+struct Operators
+{
+  static constexpr bool allows(Operator);
+};
+
+constexpr unsigned mask(Operator op)
+{
+  return 1u << int(op);
+}
+
+template<unsigned Mask>
+constexpr bool Operators<Mask>::allows(Operator op)
+{
+  return Mask & mask(op);
+}
+
+} // namespace Chic
+
+#endif // CHIC_OPERATORS_HPP
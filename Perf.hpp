@@ -0,0 +1,275 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_PERF_HPP
+#define CHIC_PERF_HPP
+
+#include "Statistics.hpp"
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Chic {
+
+// Monitor of Dictionary that wraps each phase of grow() with hardware
+// performance counters.  Counters that cannot be opened, e.g. outside Linux
+// or under a strict perf_event_paranoid, are reported as unavailable.
+class Perf
+{
+  public:
+    enum Event { cycles, instructions, l1, llc, branches, tlb, events };
+
+    struct Sample
+    {
+      Phase phase;
+      std::size_t level;
+      std::size_t length;
+      std::uint_fast64_t candidates;
+      std::uint_fast64_t counts[events];
+    };
+
+  private:
+    int _descriptors[events];
+    std::uint_fast64_t _start[events];
+    std::vector<Sample> _samples;
+    std::size_t _level;
+    bool _open;
+
+    std::uint_fast64_t _read(Event) const;
+
+  public:
+    Perf();
+    ~Perf();
+
+    Perf(const Perf&) = delete;
+    Perf& operator=(const Perf&) = delete;
+
+    bool available(Event) const;
+    const std::vector<Sample>& samples() const;
+
+    void level(std::size_t);
+    void start(Phase, std::size_t);
+    void stop(Phase, std::size_t);
+    void count(Annotation<char>, Outcome);
+    void probe(bool) const {}
+    void positive() const {}
+
+    template<typename Graph, typename Hierarchy>
+    void finish(const Graph&, const Hierarchy&) {}
+};
+
+inline
+Perf::Perf()
+  : _level(0),
+    _open(false)
+{
+  #ifdef __linux__
+    static const std::uint64_t cache = PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+
+    static const struct { std::uint32_t type; std::uint64_t config; } table[events] = {
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+      { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | cache },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+      { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | cache },
+    };
+
+    for (int event = 0; event < events; ++event) {
+      perf_event_attr attribute;
+
+      std::memset(&attribute, 0, sizeof(attribute));
+      attribute.size = sizeof(attribute);
+      attribute.type = table[event].type;
+      attribute.config = table[event].config;
+      attribute.disabled = 1;
+      attribute.exclude_kernel = 1;
+      attribute.exclude_hv = 1;
+      attribute.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      _descriptors[event] = syscall(SYS_perf_event_open, &attribute, 0, -1, -1, 0);
+    }
+  #else
+    for (int event = 0; event < events; ++event)
+      _descriptors[event] = -1;
+  #endif
+}
+
+inline
+Perf::~Perf()
+{
+  #ifdef __linux__
+    for (int event = 0; event < events; ++event)
+      if (_descriptors[event] >= 0)
+        close(_descriptors[event]);
+  #endif
+}
+
+inline
+std::uint_fast64_t Perf::_read(Event event) const
+{
+  #ifdef __linux__
+    std::uint64_t buffer[3];
+
+    if (read(_descriptors[event], buffer, sizeof(buffer)) == sizeof(buffer) && buffer[2])
+      return buffer[0] * (double(buffer[1]) / buffer[2]);
+  #endif
+
+  return 0;
+}
+
+inline
+bool Perf::available(Event event) const
+{
+  return _descriptors[event] >= 0;
+}
+
+inline
+const std::vector<Perf::Sample>& Perf::samples() const
+{
+  return _samples;
+}
+
+inline
+void Perf::level(std::size_t level)
+{
+  _level = level;
+}
+
+inline
+void Perf::start(Phase phase, std::size_t length)
+{
+  _samples.push_back({ phase, _level, length, 0, {} });
+  _open = true;
+
+  #ifdef __linux__
+    for (int event = 0; event < events; ++event) {
+      if (available(Event(event))) {
+        _start[event] = _read(Event(event));
+        ioctl(_descriptors[event], PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+  #endif
+}
+
+inline
+void Perf::stop(Phase, std::size_t)
+{
+  #ifdef __linux__
+    for (int event = 0; event < events; ++event) {
+      if (available(Event(event))) {
+        ioctl(_descriptors[event], PERF_EVENT_IOC_DISABLE, 0);
+        _samples.back().counts[event] = _read(Event(event)) - _start[event];
+      }
+    }
+  #endif
+
+  _open = false;
+}
+
+inline
+void Perf::count(Annotation<char>, Outcome)
+{
+  if (_open)
+    ++_samples.back().candidates;
+}
+
+namespace detail {
+
+template<typename Character>
+void json(std::basic_ostream<Character>& stream, const Perf& perf, const Perf::Sample& sample)
+{
+  static const char* const names[Perf::events] = { "cycles", "instructions", "l1", "llc", "branches", "tlb" };
+
+  for (int event = 0; event < Perf::events; ++event) {
+    stream << ",\"" << names[event] << "\":";
+
+    if (perf.available(Perf::Event(event)))
+      stream << sample.counts[event];
+    else
+      stream << "null";
+  }
+
+  stream << ",\"candidates\":" << sample.candidates << ",\"ipc\":";
+
+  if (perf.available(Perf::cycles) && perf.available(Perf::instructions) && sample.counts[Perf::cycles])
+    stream << double(sample.counts[Perf::instructions]) / sample.counts[Perf::cycles];
+  else
+    stream << "null";
+
+  stream << ",\"per_candidate\":{";
+
+  for (int event = Perf::l1; event < Perf::events; ++event) {
+    stream << (event == Perf::l1 ? "\"" : ",\"") << names[event] << "\":";
+
+    if (perf.available(Perf::Event(event)) && sample.candidates)
+      stream << double(sample.counts[event]) / sample.candidates;
+    else
+      stream << "null";
+  }
+
+  stream << '}';
+}
+
+} // namespace detail
+
+template<typename Character>
+std::basic_ostream<Character>& json(std::basic_ostream<Character>& stream, const Perf& perf)
+{
+  static const char* const phases[] = { "pairs", "neighbors", "factorial" };
+
+  const std::vector<Perf::Sample>& samples = perf.samples();
+
+  stream << '[';
+
+  for (std::size_t begin = 0, end; begin < samples.size(); begin = end) {
+    Perf::Sample total = { Phase::pairs, samples[begin].level, 0, 0, {} };
+
+    for (end = begin; end < samples.size() && samples[end].level == total.level; ++end) {
+      total.candidates += samples[end].candidates;
+
+      for (int event = 0; event < Perf::events; ++event)
+        total.counts[event] += samples[end].counts[event];
+    }
+
+    stream << (begin ? ",{" : "{") << "\"level\":" << total.level;
+    detail::json(stream, perf, total);
+    stream << ",\"phases\":[";
+
+    for (std::size_t k = begin; k < end; ++k) {
+      stream << (k == begin ? "{" : ",{") << "\"phase\":\"" << phases[int(samples[k].phase)] << "\",\"length\":" << samples[k].length;
+      detail::json(stream, perf, samples[k]);
+      stream << '}';
+    }
+
+    stream << "]}";
+  }
+
+  return stream << ']';
+}
+
+} // namespace Chic
+
+#endif // CHIC_PERF_HPP
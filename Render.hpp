@@ -0,0 +1,257 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_RENDER_HPP
+#define CHIC_RENDER_HPP
+
+#include "Entry.hpp"
+#include "Fraction.hpp"
+#include "Step.hpp"
+#include <algorithm>
+#include <functional>
+#include <ostream>
+#include <cstdint>
+
+namespace Chic {
+
+enum class Format { text, json, binary };
+
+// Binary form of a step.  A record with base '=' starts each answer and
+// holds the target in `value` and the digit and digit count in `first`.  Its
+// code is the first letter of the remark, if any.  Keys are stored as
+// numerator and denominator.
+struct Record
+{
+  std::uint64_t value[2];
+  std::uint64_t first[2];
+  std::uint64_t second[2];
+  char base;
+  signed char code;
+  std::uint8_t reserved[6];
+};
+
+// Open-addressing set of keys on the stack.  Once it is nearly full, every
+// insertion succeeds and repeated subexpressions are printed again.
+template<typename Key, std::size_t N = 128>
+class Memo
+{
+  private:
+    Key _keys[N];
+    bool _used[N];
+    std::size_t _size;
+
+  public:
+    Memo();
+
+    bool insert(Key);
+    void clear();
+};
+
+// Function object for Dictionary::bfs, like Breakdown, that writes steps in
+// one of several formats without allocating.  Pass it with std::ref to
+// reuse one instance for many answers.
+template<typename Key>
+class Render
+{
+  private:
+    std::ostream& _stream;
+    Format _format;
+    Memo<Key> _memo;
+    const char* _separator;
+
+    template<typename Unsigned>
+    static char _domain(Entry<Unsigned>);
+
+    template<typename Unsigned>
+    static char _domain(Fraction<Unsigned>);
+
+    template<typename Unsigned>
+    static void _encode(std::uint64_t (&)[2], Entry<Unsigned>);
+
+    template<typename Unsigned>
+    static void _encode(std::uint64_t (&)[2], Fraction<Unsigned>);
+
+  public:
+    Render(std::ostream&, Format = Format::text);
+
+    void begin(Key, int digit, std::size_t digits, const char* remark = nullptr);
+    void end();
+    void clear();
+
+    std::ostream& operator()(Key, Step<Key>);
+};
+
+template<typename Key, std::size_t N>
+Memo<Key, N>::Memo()
+  : _used(),
+    _size(0)
+{}
+
+template<typename Key, std::size_t N>
+bool Memo<Key, N>::insert(Key key)
+{
+  if (_size >= N - N / 4)
+    return true;
+
+  std::size_t index = std::hash<Key>()(key) & (N - 1);
+
+  for (; _used[index]; index = (index + 1) & (N - 1))
+    if (_keys[index] == key)
+      return false;
+
+  _keys[index] = key;
+  _used[index] = true;
+  ++_size;
+
+  return true;
+}
+
+template<typename Key, std::size_t N>
+void Memo<Key, N>::clear()
+{
+  if (_size) {
+    std::fill(_used, _used + N, false);
+    _size = 0;
+  }
+}
+
+template<typename Key>
+template<typename Unsigned>
+char Render<Key>::_domain(Entry<Unsigned>)
+{
+  return 'Z';
+}
+
+template<typename Key>
+template<typename Unsigned>
+char Render<Key>::_domain(Fraction<Unsigned>)
+{
+  return 'Q';
+}
+
+template<typename Key>
+template<typename Unsigned>
+void Render<Key>::_encode(std::uint64_t (&destination)[2], Entry<Unsigned> key)
+{
+  destination[0] = key.value();
+  destination[1] = 1;
+}
+
+template<typename Key>
+template<typename Unsigned>
+void Render<Key>::_encode(std::uint64_t (&destination)[2], Fraction<Unsigned> key)
+{
+  destination[0] = key.num();
+  destination[1] = key.den();
+}
+
+template<typename Key>
+Render<Key>::Render(std::ostream& stream, Format format)
+  : _stream(stream),
+    _format(format),
+    _separator("")
+{}
+
+template<typename Key>
+void Render<Key>::begin(Key target, int digit, std::size_t digits, const char* remark)
+{
+  Record record = {};
+
+  clear();
+
+  switch (_format) {
+    case Format::text:
+      _stream << target << '#' << digit << " in " << _domain(target) << ": " << digits << " digits";
+
+      if (remark)
+        _stream << " (" << remark << ')';
+
+      _stream << "\n--------------------\n";
+      break;
+    case Format::json:
+      _stream << "{\"target\":\"" << target << "\",\"digit\":" << digit << ",\"domain\":\"" << _domain(target)
+        << "\",\"digits\":" << digits;
+
+      if (remark)
+        _stream << ",\"remark\":\"" << remark << '"';
+
+      _stream << ",\"steps\":[";
+      break;
+    case Format::binary:
+      _encode(record.value, target);
+      record.first[0] = digit;
+      record.first[1] = digits;
+      record.base = '=';
+      record.code = remark ? *remark : 0;
+      _stream.write(reinterpret_cast<const char*>(&record), sizeof(record));
+      break;
+  }
+}
+
+template<typename Key>
+void Render<Key>::end()
+{
+  switch (_format) {
+    case Format::text:
+      _stream << '\n';
+      break;
+    case Format::json:
+      _stream << "]}\n";
+      break;
+    case Format::binary:
+      break;
+  }
+}
+
+template<typename Key>
+void Render<Key>::clear()
+{
+  _memo.clear();
+  _separator = "";
+}
+
+template<typename Key>
+std::ostream& Render<Key>::operator()(Key key, Step<Key> step)
+{
+  Record record = {};
+
+  if (!_memo.insert(key))
+    return _stream;
+
+  switch (_format) {
+    case Format::text:
+      return _stream << key << " = " << step << '\n';
+    case Format::json:
+      _stream << _separator << "{\"value\":\"" << key << "\",\"first\":\"" << step.first() << "\",\"second\":\"" << step.second()
+        << "\",\"base\":\"" << step.note().base() << "\",\"code\":" << int(step.note().code()) << '}';
+      _separator = ",";
+      return _stream;
+    case Format::binary:
+      _encode(record.value, key);
+      _encode(record.first, step.first());
+      _encode(record.second, step.second());
+      record.base = step.note().base();
+      record.code = step.note().code();
+      return _stream.write(reinterpret_cast<const char*>(&record), sizeof(record));
+  }
+
+  return _stream;
+}
+
+} // namespace Chic
+
+#endif // CHIC_RENDER_HPP
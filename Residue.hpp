@@ -0,0 +1,400 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_RESIDUE_HPP
+#define CHIC_RESIDUE_HPP
+
+#include "Arithmetic.hpp"
+#include "Integer.hpp"
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <ostream>
+#include <cstdint>
+
+namespace Chic {
+
+// Experimental key of positive rationals beyond machine width.  A value is
+// fingerprinted by its residues modulo two 61-bit primes, and its magnitude
+// is estimated by a base-2 logarithm.  Equality and hashing use residues
+// only, while the estimate decides the sign of differences and recognizes
+// small integers for exponents, factorials and square roots.
+//
+// Collisions and rounding are possible in principle, so answers made of
+// residues must be confirmed with exact arithmetic, as in Confirm.hpp.
+class Residue : public Arithmetic<Residue>
+{
+  public:
+    static const int bits = 1024;
+    static const int primes = 2;
+
+  private:
+    std::uint64_t _residues[primes];
+    double _log;
+
+    static std::uint64_t _offset(int);
+    static std::uint64_t _prime(int);
+    static std::uint64_t _multiply(std::uint64_t, std::uint64_t, int);
+    static std::uint64_t _invert(std::uint64_t, int);
+
+    Residue& _invalidate();
+
+  public:
+    Residue();
+    Residue(std::uint64_t);
+    Residue(Concatenate_t, std::size_t, int);
+
+    std::uint64_t residue(int) const;
+    double log2() const;
+    std::uint64_t integer() const;
+
+    explicit operator bool() const;
+
+    Residue inverse() const;
+    Residue sqrt() const;
+    Residue square() const;
+
+    Residue factorial() const;
+    Residue factorial(Residue) const;
+
+    Residue pow(std::uint64_t) const;
+    Residue pow(Residue) const;
+
+    Residue& operator+=(Residue);
+    Residue& operator-=(Residue);
+    Residue& operator*=(Residue);
+    Residue& operator/=(Residue);
+};
+
+inline
+std::uint64_t Residue::_offset(int k)
+{
+  return k ? 31 : 1;
+}
+
+// 2^61 - 1 and 2^61 - 31
+inline
+std::uint64_t Residue::_prime(int k)
+{
+  return (std::uint64_t(1) << 61) - _offset(k);
+}
+
+inline
+std::uint64_t Residue::_multiply(std::uint64_t x, std::uint64_t y, int k)
+{
+#ifdef __SIZEOF_INT128__
+  const std::uint64_t mask = (std::uint64_t(1) << 61) - 1;
+  const std::uint64_t c = _offset(k);
+
+  // 2^61 = c modulo the prime
+  unsigned __int128 product = static_cast<unsigned __int128>(x) * y;
+  unsigned __int128 folded = (product & mask) + (product >> 61) * c;
+  std::uint64_t value = (folded & mask) + std::uint64_t(folded >> 61) * c;
+
+  while (value >= _prime(k))
+    value -= _prime(k);
+
+  return value;
+#else
+  std::uint64_t result = 0;
+
+  for (; y; y >>= 1, x = (x << 1) % _prime(k))
+    if (y & 1)
+      result = (result + x) % _prime(k);
+
+  return result;
+#endif
+}
+
+// Inverse by Fermat's little theorem
+inline
+std::uint64_t Residue::_invert(std::uint64_t x, int k)
+{
+  std::uint64_t result = 1;
+
+  for (std::uint64_t exponent = _prime(k) - 2; exponent; exponent >>= 1) {
+    if (exponent & 1)
+      result = _multiply(result, x, k);
+
+    x = _multiply(x, x, k);
+  }
+
+  return result;
+}
+
+inline
+Residue& Residue::_invalidate()
+{
+  for (int k = 0; k < primes; ++k)
+    _residues[k] = 0;
+
+  _log = std::numeric_limits<double>::quiet_NaN();
+  return *this;
+}
+
+inline
+Residue::Residue()
+{
+  _invalidate();
+}
+
+inline
+Residue::Residue(std::uint64_t value)
+{
+  for (int k = 0; k < primes; ++k)
+    _residues[k] = value % _prime(k);
+
+  _log = value ? std::log2(double(value)) : std::numeric_limits<double>::quiet_NaN();
+}
+
+inline
+Residue::Residue(Concatenate_t, std::size_t repeats, int digit)
+{
+  for (int k = 0; k < primes; ++k) {
+    _residues[k] = 0;
+
+    for (std::size_t count = 0; count < repeats; ++count)
+      _residues[k] = (_multiply(_residues[k], 10, k) + digit) % _prime(k);
+  }
+
+  // digit * (10^repeats - 1) / 9
+  _log = std::log2(digit / 9.0) + repeats * std::log2(10.0) + std::log1p(-std::pow(10.0, -double(repeats))) / std::log(2.0);
+}
+
+inline
+std::uint64_t Residue::residue(int k) const
+{
+  return _residues[k];
+}
+
+inline
+double Residue::log2() const
+{
+  return _log;
+}
+
+// The value if it is an integer below 2^50, or 0 otherwise
+inline
+std::uint64_t Residue::integer() const
+{
+  if (!(_log > -0.5 && _log < 50))
+    return 0;
+
+  std::uint64_t value = std::llround(std::exp2(_log));
+
+  for (std::uint64_t candidate = value - !!value; candidate <= value + 1; ++candidate)
+    if (_residues[0] == candidate && _residues[1] == candidate)
+      return candidate;
+
+  return 0;
+}
+
+inline
+Residue::operator bool() const
+{
+  return !std::isnan(_log);
+}
+
+inline
+Residue Residue::inverse() const
+{
+  Residue result = *this;
+
+  for (int k = 0; k < primes; ++k) {
+    if (!_residues[k])
+      return result._invalidate();
+
+    result._residues[k] = _invert(_residues[k], k);
+  }
+
+  result._log = -_log;
+  return result;
+}
+
+inline
+Residue Residue::sqrt() const
+{
+  std::uint64_t value = integer();
+  std::uint64_t root = std::llround(std::sqrt(double(value)));
+
+  return value && root * root == value ? Residue(root) : Residue();
+}
+
+inline
+Residue Residue::square() const
+{
+  return *this * *this;
+}
+
+inline
+Residue Residue::factorial() const
+{
+  std::uint64_t n = integer();
+  Residue result = 1;
+
+  if (!n || std::lgamma(n + 1.0) / std::log(2.0) > bits)
+    return Residue();
+
+  for (std::uint64_t k = 2; k <= n; ++k)
+    result *= Residue(k);
+
+  return result;
+}
+
+// x! / y!
+inline
+Residue Residue::factorial(Residue other) const
+{
+  std::uint64_t x = integer();
+  std::uint64_t y = other.integer();
+
+  if (!(x && y))
+    return Residue();
+
+  if (x < y)
+    return other.factorial(*this).inverse();
+
+  Residue result = 1;
+
+  for (std::uint64_t k = y + 1; k <= x; ++k)
+    if (!((result *= Residue(k)).log2() <= bits))
+      return Residue();
+
+  return result;
+}
+
+inline
+Residue Residue::pow(std::uint64_t exponent) const
+{
+  Residue base = *this;
+  Residue result = 1;
+
+  if (!(std::abs(_log * exponent) <= bits))
+    return Residue();
+
+  for (; exponent; exponent >>= 1) {
+    if (exponent & 1)
+      result *= base;
+
+    base = base.square();
+  }
+
+  return result;
+}
+
+inline
+Residue Residue::pow(Residue exponent) const
+{
+  std::uint64_t integral = exponent.integer();
+
+  return integral ? pow(integral) : Residue();
+}
+
+inline
+Residue& Residue::operator+=(Residue other)
+{
+  if (!(*this && other))
+    return _invalidate();
+
+  double high = (std::max)(_log, other._log);
+  double low = (std::min)(_log, other._log);
+
+  for (int k = 0; k < primes; ++k)
+    _residues[k] = (_residues[k] + other._residues[k]) % _prime(k);
+
+  _log = high + std::log1p(std::exp2(low - high)) / std::log(2.0);
+  return *this;
+}
+
+// Differences whose sign the estimates cannot tell are invalid.
+inline
+Residue& Residue::operator-=(Residue other)
+{
+  const double epsilon = 1e-9;
+  double gap = _log - other._log;
+
+  if (!(gap > epsilon))
+    return _invalidate();
+
+  for (int k = 0; k < primes; ++k)
+    _residues[k] = (_residues[k] + _prime(k) - other._residues[k]) % _prime(k);
+
+  _log += std::log2(-std::expm1(-gap * std::log(2.0)));
+  return *this;
+}
+
+inline
+Residue& Residue::operator*=(Residue other)
+{
+  for (int k = 0; k < primes; ++k)
+    _residues[k] = _multiply(_residues[k], other._residues[k], k);
+
+  _log += other._log;
+  return *this;
+}
+
+inline
+Residue& Residue::operator/=(Residue other)
+{
+  return *this *= other.inverse();
+}
+
+inline
+bool operator==(Residue x, Residue y)
+{
+  return x && y && x.residue(0) == y.residue(0) && x.residue(1) == y.residue(1);
+}
+
+// Integers and their inverses are printed exactly, other values by their
+// magnitude.
+template<typename Character>
+std::basic_ostream<Character>& operator<<(std::basic_ostream<Character>& stream, Residue residue)
+{
+  if (std::uint64_t integer = residue.integer())
+    return stream << integer;
+
+  if (std::uint64_t integer = residue.inverse().integer())
+    return stream << '(' << 1 << '/' << integer << ')';
+
+  if (residue)
+    return stream << '~' << 2 << '^' << residue.log2();
+
+  return stream << 'n' << 'a' << 'n';
+}
+
+} // namespace Chic
+
+namespace std {
+
+inline
+bool isnormal(Chic::Residue residue)
+{
+  return bool(residue);
+}
+
+template<>
+struct hash<Chic::Residue>
+{
+  std::size_t operator()(Chic::Residue residue) const
+  {
+    return residue.residue(0) ^ Chic::rotate(residue.residue(1), 32);
+  }
+};
+
+} // namespace std
+
+#endif // CHIC_RESIDUE_HPP
@@ -0,0 +1,198 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_RING_HPP
+#define CHIC_RING_HPP
+
+#include <cstddef>
+#include <initializer_list>
+
+namespace Chic {
+
+// Double-ended buffer that lives on the stack up to N items and moves to the
+// heap beyond.  It meets the container requirements of std::queue and
+// std::stack, so it can replace the default containers of Dictionary::bfs
+// and Dictionary::dfs.
+template<typename T, std::size_t N = 256>
+class Ring
+{
+  private:
+    static_assert(N && !(N & (N - 1)), "The capacity must be a power of 2");
+
+    T _inline[N];
+    T* _items;
+    std::size_t _capacity;
+    std::size_t _head;
+    std::size_t _size;
+
+    void _grow();
+
+  public:
+    typedef T value_type;
+    typedef std::size_t size_type;
+    typedef T& reference;
+    typedef const T& const_reference;
+
+    Ring(std::initializer_list<T> = {});
+    Ring(const Ring&);
+    Ring& operator=(const Ring&);
+    ~Ring();
+
+    bool empty() const;
+    size_type size() const;
+
+    reference front();
+    const_reference front() const;
+    reference back();
+    const_reference back() const;
+
+    void push_back(const T&);
+    void pop_front();
+    void pop_back();
+};
+
+template<typename T, std::size_t N>
+Ring<T, N>::Ring(std::initializer_list<T> items)
+  : _items(_inline),
+    _capacity(N),
+    _head(0),
+    _size(0)
+{
+  for (const T& item: items)
+    push_back(item);
+}
+
+template<typename T, std::size_t N>
+Ring<T, N>::Ring(const Ring& other)
+  : _items(_inline),
+    _capacity(N),
+    _head(0),
+    _size(0)
+{
+  *this = other;
+}
+
+template<typename T, std::size_t N>
+Ring<T, N>& Ring<T, N>::operator=(const Ring& other)
+{
+  if (this == &other)
+    return *this;
+
+  if (_capacity < other._size) {
+    T* items = new T[other._capacity];
+
+    if (_items != _inline)
+      delete[] _items;
+
+    _items = items;
+    _capacity = other._capacity;
+  }
+
+  _head = 0;
+  _size = other._size;
+
+  for (std::size_t k = 0; k < _size; ++k)
+    _items[k] = other._items[(other._head + k) & (other._capacity - 1)];
+
+  return *this;
+}
+
+template<typename T, std::size_t N>
+Ring<T, N>::~Ring()
+{
+  if (_items != _inline)
+    delete[] _items;
+}
+
+// Double the capacity, moving the items to the heap in order
+template<typename T, std::size_t N>
+void Ring<T, N>::_grow()
+{
+  T* items = new T[2 * _capacity];
+
+  for (std::size_t k = 0; k < _size; ++k)
+    items[k] = _items[(_head + k) & (_capacity - 1)];
+
+  if (_items != _inline)
+    delete[] _items;
+
+  _items = items;
+  _capacity *= 2;
+  _head = 0;
+}
+
+template<typename T, std::size_t N>
+bool Ring<T, N>::empty() const
+{
+  return !_size;
+}
+
+template<typename T, std::size_t N>
+std::size_t Ring<T, N>::size() const
+{
+  return _size;
+}
+
+template<typename T, std::size_t N>
+T& Ring<T, N>::front()
+{
+  return _items[_head];
+}
+
+template<typename T, std::size_t N>
+const T& Ring<T, N>::front() const
+{
+  return _items[_head];
+}
+
+template<typename T, std::size_t N>
+T& Ring<T, N>::back()
+{
+  return _items[(_head + _size - 1) & (_capacity - 1)];
+}
+
+template<typename T, std::size_t N>
+const T& Ring<T, N>::back() const
+{
+  return _items[(_head + _size - 1) & (_capacity - 1)];
+}
+
+template<typename T, std::size_t N>
+void Ring<T, N>::push_back(const T& item)
+{
+  if (_size == _capacity)
+    _grow();
+
+  _items[(_head + _size++) & (_capacity - 1)] = item;
+}
+
+template<typename T, std::size_t N>
+void Ring<T, N>::pop_front()
+{
+  _head = (_head + 1) & (_capacity - 1);
+  --_size;
+}
+
+template<typename T, std::size_t N>
+void Ring<T, N>::pop_back()
+{
+  --_size;
+}
+
+} // namespace Chic
+
+#endif // CHIC_RING_HPP
@@ -0,0 +1,564 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_SMOOTH_HPP
+#define CHIC_SMOOTH_HPP
+
+#include "Fraction.hpp"
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <ostream>
+#include <cstdint>
+#include <cstring>
+
+namespace Chic {
+
+// Experimental key of the same positive rationals as `Fraction`, factored
+// into exponents of the primes up to 19 and a cofactor coprime to them.
+// Products, quotients, powers and square roots work on exponents and only
+// take gcds of cofactors, while sums and differences go through `Fraction`
+// and factor the result again.
+template<typename Unsigned>
+class Smooth : public Arithmetic<Smooth<Unsigned>>
+{
+  public:
+    static const int primes = 8;
+    static const int bits = std::numeric_limits<Unsigned>::digits;
+
+  private:
+    Unsigned _num;
+    Unsigned _den;
+    std::int8_t _exponents[primes];
+
+    static_assert(primes == sizeof(std::uint64_t), "Exponents must pack into one word.");
+
+    struct Table
+    {
+      Unsigned powers[primes][bits];
+      Unsigned inverses[primes];
+      Unsigned limits[primes];
+
+      Table();
+    };
+
+    static Unsigned _prime(int);
+    static const Table& _table();
+    static Unsigned _root(Unsigned);
+
+    Unsigned _factor(Unsigned, int);
+    Unsigned _expand(Unsigned, int) const;
+    Smooth& _validate();
+    Smooth& _assign(Fraction<Unsigned>, Unsigned);
+    Smooth& _invalidate();
+
+  public:
+    Smooth();
+    Smooth(Unsigned);
+    Smooth(Fraction<Unsigned>);
+    Smooth(Concatenate_t, std::size_t, int);
+
+    Unsigned cofactor(bool denominator = false) const;
+    int exponent(int) const;
+    std::uint64_t exponents() const;
+    Fraction<Unsigned> fraction() const;
+    Unsigned integer() const;
+
+    explicit operator bool() const;
+
+    Smooth inverse() const;
+    Smooth sqrt() const;
+    Smooth square() const;
+
+    Smooth factorial() const;
+    Smooth factorial(Smooth) const;
+
+    Smooth pow(Unsigned) const;
+    Smooth pow(Smooth) const;
+
+    Smooth& operator+=(Smooth);
+    Smooth& operator-=(Smooth);
+    Smooth& operator*=(Smooth);
+    Smooth& operator/=(Smooth);
+};
+
+template<typename Unsigned>
+Unsigned Smooth<Unsigned>::_prime(int k)
+{
+  static const unsigned char values[primes] = { 2, 3, 5, 7, 11, 13, 17, 19 };
+  return values[k];
+}
+
+// Powers of each prime, 0 where they overflow, and the inverses of odd
+// primes modulo 2^bits.  A multiple n of p is exactly the n with n / p =
+// n * inverse below max / p.
+template<typename Unsigned>
+Smooth<Unsigned>::Table::Table()
+{
+  for (int k = 0; k < primes; ++k) {
+    Overflow<Unsigned> power = 1;
+    Unsigned inverse = _prime(k);
+
+    for (int e = 0; e < bits; ++e) {
+      powers[k][e] = power;
+
+      if (power && (power *= _prime(k)))
+        power = 0;
+    }
+
+    for (int step = 0; step < 6; ++step)
+      inverse *= 2 - _prime(k) * inverse;
+
+    inverses[k] = inverse;
+    limits[k] = std::numeric_limits<Unsigned>::max() / _prime(k);
+  }
+}
+
+template<typename Unsigned>
+const typename Smooth<Unsigned>::Table& Smooth<Unsigned>::_table()
+{
+  static const Table table;
+  return table;
+}
+
+template<typename Unsigned>
+Unsigned Smooth<Unsigned>::_root(Unsigned value)
+{
+  Unsigned root = std::sqrt(value);
+  return root * root == value ? root : 0;
+}
+
+template<typename Unsigned>
+Unsigned Smooth<Unsigned>::_factor(Unsigned value, int sign)
+{
+  const Table& table = _table();
+  int shift = ctz(value);
+
+  value >>= shift;
+  _exponents[0] += sign * shift;
+
+  for (int k = 1; k < primes; ++k) {
+    Unsigned inverse = table.inverses[k];
+    Unsigned limit = table.limits[k];
+    int count = 0;
+
+    for (; Unsigned(value * inverse) <= limit; ++count)
+      value *= inverse;
+
+    _exponents[k] += sign * count;
+  }
+
+  return value;
+}
+
+// The numerator or denominator with its smooth part, or 0 if it overflows
+template<typename Unsigned>
+Unsigned Smooth<Unsigned>::_expand(Unsigned cofactor, int sign) const
+{
+  const Table& table = _table();
+  Overflow<Unsigned> value = cofactor;
+
+  for (std::uint64_t word = exponents(); word; ) {
+    int k = ctz(word) / 8;
+    int exponent = sign * _exponents[k];
+
+    word &= ~(std::uint64_t(0xFF) << 8 * k);
+
+    if (exponent > 0 && (exponent >= bits || (value *= table.powers[k][exponent])))
+      return 0;
+  }
+
+  return value;
+}
+
+// Values are as wide as the numerator and denominator of a `Fraction`.
+// Widths bounded by ceilings of base-2 logarithms of the primes spare most
+// expansions.
+template<typename Unsigned>
+Smooth<Unsigned>& Smooth<Unsigned>::_validate()
+{
+  static const unsigned char ceilings[primes] = { 1, 2, 3, 3, 4, 4, 5, 5 };
+
+  if (!(_num && _den))
+    return _invalidate();
+
+  int widths[] = { bits - clz(_num), bits - clz(_den) };
+
+  for (int k = 0; k < primes; ++k)
+    widths[_exponents[k] < 0] += std::abs(_exponents[k]) * ceilings[k];
+
+  if (widths[0] <= bits && widths[1] <= bits)
+    return *this;
+
+  if (!(_expand(_num, 1) && _expand(_den, -1)))
+    _invalidate();
+
+  return *this;
+}
+
+// Factor a sum or difference computed by `Fraction`, which only keeps
+// common factors of the denominators of its operands.  Common smooth
+// factors cancel in exponents, so only `common`, the gcd of the cofactors
+// of the denominators, needs another gcd.
+template<typename Unsigned>
+Smooth<Unsigned>& Smooth<Unsigned>::_assign(Fraction<Unsigned> fraction, Unsigned common)
+{
+  if (!std::isnormal(fraction))
+    return _invalidate();
+
+  _num = fraction.num();
+  _den = fraction.den();
+  std::memset(_exponents, 0, primes);
+
+  _num = _factor(_num, 1);
+  _den = _factor(_den, -1);
+
+  if (common != 1) {
+    Unsigned divisor = gcd(_num, common);
+    _num /= divisor;
+    _den /= divisor;
+  }
+
+  return *this;
+}
+
+template<typename Unsigned>
+Smooth<Unsigned>& Smooth<Unsigned>::_invalidate()
+{
+  _num = 0;
+  _den = 0;
+  std::memset(_exponents, 0, primes);
+
+  return *this;
+}
+
+template<typename Unsigned>
+Smooth<Unsigned>::Smooth()
+{
+  _invalidate();
+}
+
+template<typename Unsigned>
+Smooth<Unsigned>::Smooth(Unsigned value)
+  : _num(value),
+    _den(!!value),
+    _exponents()
+{
+  if (value)
+    _num = _factor(_num, 1);
+}
+
+template<typename Unsigned>
+Smooth<Unsigned>::Smooth(Fraction<Unsigned> fraction)
+  : _num(fraction.num()),
+    _den(fraction.den()),
+    _exponents()
+{
+  if (std::isnormal(fraction)) {
+    _num = _factor(_num, 1);
+    _den = _factor(_den, -1);
+
+    if (_num != 1 && _den != 1) {
+      Unsigned divisor = gcd(_num, _den);
+      _num /= divisor;
+      _den /= divisor;
+    }
+  }
+  else {
+    _invalidate();
+  }
+}
+
+template<typename Unsigned>
+Smooth<Unsigned>::Smooth(Concatenate_t, std::size_t repeats, int digit)
+  : Smooth(concatenate<Unsigned>(repeats, digit))
+{}
+
+template<typename Unsigned>
+Unsigned Smooth<Unsigned>::cofactor(bool denominator) const
+{
+  return denominator ? _den : _num;
+}
+
+template<typename Unsigned>
+int Smooth<Unsigned>::exponent(int k) const
+{
+  return _exponents[k];
+}
+
+// All exponents packed in one word
+template<typename Unsigned>
+std::uint64_t Smooth<Unsigned>::exponents() const
+{
+  std::uint64_t word;
+
+  std::memcpy(&word, _exponents, sizeof(word));
+  return word;
+}
+
+template<typename Unsigned>
+Fraction<Unsigned> Smooth<Unsigned>::fraction() const
+{
+  if (!_den)
+    return Fraction<Unsigned>::nan();
+
+  return { Fraction<Unsigned>::Canonical, _expand(_num, 1), _expand(_den, -1) };
+}
+
+// The value if it is an integer, or 0 otherwise
+template<typename Unsigned>
+Unsigned Smooth<Unsigned>::integer() const
+{
+  if (_den != 1)
+    return 0;
+
+  for (int k = 0; k < primes; ++k)
+    if (_exponents[k] < 0)
+      return 0;
+
+  return _expand(_num, 1);
+}
+
+template<typename Unsigned>
+Smooth<Unsigned>::operator bool() const
+{
+  return _den;
+}
+
+template<typename Unsigned>
+Smooth<Unsigned> Smooth<Unsigned>::inverse() const
+{
+  Smooth result = *this;
+
+  result._num = _den;
+  result._den = _num;
+
+  for (int k = 0; k < primes; ++k)
+    result._exponents[k] = -_exponents[k];
+
+  return result;
+}
+
+// Even exponents halve, and only cofactors need square roots.
+template<typename Unsigned>
+Smooth<Unsigned> Smooth<Unsigned>::sqrt() const
+{
+  Smooth result = *this;
+
+  for (int k = 0; k < primes; ++k) {
+    if (_exponents[k] & 1)
+      return Smooth();
+
+    result._exponents[k] = _exponents[k] / 2;
+  }
+
+  result._num = _num == 1 ? 1 : _root(_num);
+  result._den = _den == 1 ? 1 : _root(_den);
+
+  return result._num && result._den ? result : result._invalidate();
+}
+
+template<typename Unsigned>
+Smooth<Unsigned> Smooth<Unsigned>::square() const
+{
+  return pow(2);
+}
+
+template<typename Unsigned>
+Smooth<Unsigned> Smooth<Unsigned>::factorial() const
+{
+  if (Unsigned value = integer())
+    if (Unsigned result = Chic::factorial(Overflow<Unsigned>(value)))
+      return result;
+
+  return Smooth();
+}
+
+// x! / y!
+template<typename Unsigned>
+Smooth<Unsigned> Smooth<Unsigned>::factorial(Smooth other) const
+{
+  Unsigned x = integer();
+  Unsigned y = other.integer();
+
+  if (x && y) {
+    if (Unsigned integer = Entry<Unsigned>((std::max)(x, y)).factorial((std::min)(x, y))) {
+      Smooth result(integer);
+      return x > y ? result : result.inverse();
+    }
+  }
+
+  return Smooth();
+}
+
+// Exponents scale, and only cofactors are multiplied.
+template<typename Unsigned>
+Smooth<Unsigned> Smooth<Unsigned>::pow(Unsigned exponent) const
+{
+  Smooth result = *this;
+  Overflow<Unsigned> num = 1;
+  Overflow<Unsigned> den = 1;
+
+  if (!_den)
+    return result;
+
+  for (int k = 0; k < primes; ++k) {
+    if (_exponents[k] && exponent >= Unsigned(bits))
+      return Smooth();
+
+    int scaled = _exponents[k] * int(exponent);
+
+    if (scaled >= bits || scaled <= -bits)
+      return Smooth();
+
+    result._exponents[k] = scaled;
+  }
+
+  for (Unsigned base[] = { _num, _den }; exponent; exponent >>= 1) {
+    if (exponent & 1 && ((num *= base[0]) || (den *= base[1])))
+      return Smooth();
+
+    if (exponent > 1) {
+      Overflow<Unsigned> squares[] = { base[0], base[1] };
+
+      if ((squares[0] *= base[0]) || (squares[1] *= base[1]))
+        return Smooth();
+
+      base[0] = squares[0];
+      base[1] = squares[1];
+    }
+  }
+
+  result._num = num;
+  result._den = den;
+
+  return result._validate();
+}
+
+template<typename Unsigned>
+Smooth<Unsigned> Smooth<Unsigned>::pow(Smooth exponent) const
+{
+  Unsigned integral = exponent.integer();
+
+  return integral ? pow(integral) : Smooth();
+}
+
+template<typename Unsigned>
+Smooth<Unsigned>& Smooth<Unsigned>::operator+=(Smooth other)
+{
+  if (!(*this && other))
+    return _invalidate();
+
+  Unsigned common = _den == 1 || other._den == 1 ? 1 : gcd(_den, other._den);
+
+  return _assign(fraction() + other.fraction(), common);
+}
+
+template<typename Unsigned>
+Smooth<Unsigned>& Smooth<Unsigned>::operator-=(Smooth other)
+{
+  if (!(*this && other))
+    return _invalidate();
+
+  Unsigned common = _den == 1 || other._den == 1 ? 1 : gcd(_den, other._den);
+
+  return _assign(fraction() - other.fraction(), common);
+}
+
+// Cofactors of reduced operands only share factors across the product, and
+// only when neither of them is 1.
+template<typename Unsigned>
+Smooth<Unsigned>& Smooth<Unsigned>::operator*=(Smooth other)
+{
+  if (!(*this && other))
+    return _invalidate();
+
+  Unsigned a = _num;
+  Unsigned b = _den;
+  Unsigned c = other._num;
+  Unsigned d = other._den;
+
+  if (a != 1 && d != 1) {
+    Unsigned divisor = gcd(a, d);
+    a /= divisor;
+    d /= divisor;
+  }
+
+  if (c != 1 && b != 1) {
+    Unsigned divisor = gcd(c, b);
+    c /= divisor;
+    b /= divisor;
+  }
+
+  Overflow<Unsigned> num = a;
+  Overflow<Unsigned> den = b;
+
+  if ((num *= c) || (den *= d))
+    return _invalidate();
+
+  _num = num;
+  _den = den;
+
+  for (int k = 0; k < primes; ++k)
+    _exponents[k] += other._exponents[k];
+
+  return _validate();
+}
+
+template<typename Unsigned>
+Smooth<Unsigned>& Smooth<Unsigned>::operator/=(Smooth other)
+{
+  return *this *= other.inverse();
+}
+
+template<typename Unsigned>
+bool operator==(Smooth<Unsigned> x, Smooth<Unsigned> y)
+{
+  return x && x.cofactor() == y.cofactor() && x.cofactor(true) == y.cofactor(true) && x.exponents() == y.exponents();
+}
+
+template<typename Character, typename Unsigned>
+std::basic_ostream<Character>& operator<<(std::basic_ostream<Character>& stream, Smooth<Unsigned> smooth)
+{
+  return stream << smooth.fraction();
+}
+
+} // namespace Chic
+
+namespace std {
+
+template<typename Unsigned>
+bool isnormal(Chic::Smooth<Unsigned> smooth)
+{
+  return bool(smooth);
+}
+
+template<typename Unsigned>
+struct hash<Chic::Smooth<Unsigned>>
+{
+  std::size_t operator()(Chic::Smooth<Unsigned> smooth) const
+  {
+    std::uint64_t exponents = smooth.exponents();
+    std::size_t num = smooth.cofactor();
+
+    return Chic::rotate(num, std::numeric_limits<std::size_t>::digits / 2) ^ smooth.cofactor(true) ^ std::size_t(exponents * 0x9e3779b97f4a7c15);
+  }
+};
+
+} // namespace std
+
+#endif // CHIC_SMOOTH_HPP
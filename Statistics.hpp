@@ -0,0 +1,204 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_STATISTICS_HPP
+#define CHIC_STATISTICS_HPP
+
+#include "Annotation.hpp"
+#include "Footprint.hpp"
+#include "Monitor.hpp"
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace Chic {
+
+class Statistics
+{
+  public:
+    struct Counter
+    {
+      std::uint_fast64_t generated;
+      std::uint_fast64_t rejected;
+      std::uint_fast64_t pruned;
+      std::uint_fast64_t duplicate;
+      std::uint_fast64_t inserted;
+    };
+
+    struct Level
+    {
+      Counter counters[operators];
+      double seconds[3];
+
+      std::size_t keys;
+      std::size_t buckets;
+      double load;
+      double probe;
+      std::size_t longest;
+
+      std::size_t graph;
+      std::size_t hierarchy;
+    };
+
+    // Lookups that consulted a filter, those it answered without probing
+    // the graph, and those it passed but the graph rejected
+    struct Lookups
+    {
+      std::uint_fast64_t probes;
+      std::uint_fast64_t avoided;
+      std::uint_fast64_t positives;
+    };
+
+  private:
+    typedef std::chrono::steady_clock Clock;
+
+    std::vector<Level> _levels;
+    Clock::time_point _start;
+    mutable Lookups _lookups = {};
+
+  public:
+    void level(std::size_t);
+    void start(Phase, std::size_t);
+    void stop(Phase, std::size_t);
+    void count(Annotation<char>, Outcome);
+    void probe(bool) const;
+    void positive() const;
+
+    template<typename Graph, typename Hierarchy>
+    void finish(const Graph&, const Hierarchy&);
+
+    const std::vector<Level>& levels() const;
+    const Lookups& lookups() const;
+};
+
+inline
+void Statistics::level(std::size_t)
+{
+  _levels.emplace_back();
+}
+
+inline
+void Statistics::start(Phase, std::size_t)
+{
+  _start = Clock::now();
+}
+
+inline
+void Statistics::stop(Phase phase, std::size_t)
+{
+  _levels.back().seconds[int(phase)] += std::chrono::duration<double>(Clock::now() - _start).count();
+}
+
+inline
+void Statistics::count(Annotation<char> note, Outcome outcome)
+{
+  Counter& counter = _levels.back().counters[int(classify(note))];
+
+  ++counter.generated;
+  counter.rejected += outcome == Outcome::rejected;
+  counter.pruned += outcome == Outcome::pruned;
+  counter.duplicate += outcome == Outcome::duplicate;
+  counter.inserted += outcome == Outcome::inserted;
+}
+
+// Lookups are counted without synchronization, so a dictionary monitored
+// by Statistics must not be read from several threads.
+inline
+void Statistics::probe(bool maybe) const
+{
+  ++_lookups.probes;
+  _lookups.avoided += !maybe;
+}
+
+inline
+void Statistics::positive() const
+{
+  ++_lookups.positives;
+}
+
+template<typename Graph, typename Hierarchy>
+void Statistics::finish(const Graph& graph, const Hierarchy& hierarchy)
+{
+  Level& level = _levels.back();
+  std::size_t probes = 0;
+
+  for (std::size_t bucket = 0; bucket < graph.bucket_count(); ++bucket) {
+    std::size_t size = graph.bucket_size(bucket);
+
+    probes += size * (size + 1) / 2;
+    level.longest = (std::max)(level.longest, size);
+  }
+
+  level.keys = hierarchy.back().size();
+  level.buckets = graph.bucket_count();
+  level.load = graph.load_factor();
+  level.probe = graph.size() ? double(probes) / graph.size() : 0;
+  level.graph = footprint(graph);
+  level.hierarchy = footprint(hierarchy);
+}
+
+inline
+const std::vector<Statistics::Level>& Statistics::levels() const
+{
+  return _levels;
+}
+
+inline
+const Statistics::Lookups& Statistics::lookups() const
+{
+  return _lookups;
+}
+
+template<typename Character>
+std::basic_ostream<Character>& json(std::basic_ostream<Character>& stream, const Statistics& statistics)
+{
+  static const char* const phases[] = { "pairs", "neighbors", "factorial" };
+  const char* separator = "";
+
+  stream << '[';
+
+  for (const Statistics::Level& level: statistics.levels()) {
+    stream << separator << "{\"keys\":" << level.keys << ",\"operators\":{";
+
+    for (int op = 0; op < operators; ++op) {
+      const Statistics::Counter& counter = level.counters[op];
+
+      stream << (op ? ",\"" : "\"") << symbol(Operator(op)) << "\":{\"generated\":" << counter.generated
+        << ",\"rejected\":" << counter.rejected << ",\"pruned\":" << counter.pruned
+        << ",\"duplicate\":" << counter.duplicate
+        << ",\"inserted\":" << counter.inserted << '}';
+    }
+
+    stream << "},\"seconds\":{";
+
+    for (int phase = 0; phase < 3; ++phase)
+      stream << (phase ? ",\"" : "\"") << phases[phase] << "\":" << level.seconds[phase];
+
+    stream << "},\"buckets\":" << level.buckets << ",\"load\":" << level.load
+      << ",\"probe\":" << level.probe << ",\"longest\":" << level.longest
+      << ",\"bytes\":{\"graph\":" << level.graph << ",\"hierarchy\":" << level.hierarchy << "}}";
+
+    separator = ",";
+  }
+
+  return stream << ']';
+}
+
+} // namespace Chic
+
+#endif // CHIC_STATISTICS_HPP
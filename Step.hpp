@@ -32,6 +32,7 @@ class Step
     Key _first;
     Key _second;
     Annotation<char> _note;
+    unsigned char _digits;
 
   public:
     Step(Key = {}, Annotation<char> = {});
@@ -40,6 +41,8 @@ class Step
     Key first() const;
     Key second() const;
     Annotation<char> note() const;
+    std::size_t digits() const;
+    Step at(std::size_t) const;
     operator bool() const;
 };
 
@@ -47,14 +50,16 @@ template<typename Key>
 Step<Key>::Step(Key first, Annotation<char> note)
   : _first(first),
     _second(0),
-    _note(note)
+    _note(note),
+    _digits(0)
 {}
 
 template<typename Key>
 Step<Key>::Step(Key first, Key second, Annotation<char> note)
   : _first(first),
     _second(second),
-    _note(note)
+    _note(note),
+    _digits(0)
 {}
 
 template<typename Key>
@@ -75,6 +80,22 @@ Annotation<char> Step<Key>::note() const
   return _note;
 }
 
+// Digits of the key made by this step, if recorded by the dictionary
+template<typename Key>
+std::size_t Step<Key>::digits() const
+{
+  return _digits;
+}
+
+// This step recorded as making a key of `digits` digits
+template<typename Key>
+Step<Key> Step<Key>::at(std::size_t digits) const
+{
+  Step step = *this;
+  step._digits = digits;
+  return step;
+}
+
 template<typename Key>
 Step<Key>::operator bool() const
 {
@@ -0,0 +1,213 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_TABLE_HPP
+#define CHIC_TABLE_HPP
+
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Chic {
+
+// Precomputed answers for every target in [0, bound]
+//
+// The file starts with a header, followed by one 32-bit cell per target,
+// digit and key type.  Like Dense.hpp, a cell holds the digits in the low 5
+// bits and the index of its breakdown above them.  Then come the end
+// offsets of the breakdowns, and a blob of the breakdowns rendered as text.
+// A cell with zero digits means no answer within the depth the table was
+// generated with, and index 0 means no breakdown.
+class Table
+{
+  public:
+    struct Header
+    {
+      char magic[8];
+      std::uint64_t bound;
+      std::uint64_t count;
+    };
+
+    static const std::uint64_t limit = std::uint64_t(1) << 27;
+
+    static std::size_t index(std::uint64_t, int, bool);
+    static std::uint32_t cell(std::size_t digits, std::uint64_t breakdown);
+
+  private:
+    const char* _data;
+    std::size_t _size;
+    std::vector<char> _buffer;
+
+    const Header& _header() const;
+    const std::uint32_t* _cells() const;
+    const std::uint64_t* _offsets() const;
+    void _release();
+
+  public:
+    explicit Table(const char*);
+    ~Table();
+
+    Table(const Table&) = delete;
+    Table& operator=(const Table&) = delete;
+
+    explicit operator bool() const;
+    std::uint64_t bound() const;
+
+    std::size_t digits(std::uint64_t, int, bool) const;
+    const char* text(std::uint64_t, int, bool, std::size_t&) const;
+};
+
+inline
+std::size_t Table::index(std::uint64_t target, int digit, bool rational)
+{
+  return (target * 9 + digit - 1) * 2 + rational;
+}
+
+inline
+std::uint32_t Table::cell(std::size_t digits, std::uint64_t breakdown)
+{
+  return breakdown << 5 | digits;
+}
+
+inline
+Table::Table(const char* path)
+  : _data(nullptr),
+    _size(0)
+{
+  #if defined(__unix__) || defined(__APPLE__)
+    int descriptor = open(path, O_RDONLY);
+    struct stat status;
+
+    if (descriptor < 0)
+      return;
+
+    if (fstat(descriptor, &status) == 0 && status.st_size) {
+      void* map = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+
+      if (map != MAP_FAILED) {
+        _data = static_cast<const char*>(map);
+        _size = status.st_size;
+      }
+    }
+
+    close(descriptor);
+  #else
+    std::ifstream stream(path, std::ios_base::binary);
+    _buffer.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    _data = _buffer.data();
+    _size = _buffer.size();
+  #endif
+
+  if (_size < sizeof(Header) || std::memcmp(_header().magic, "CHICTAB2", sizeof(Header::magic))
+      || _header().count >= limit || _size < sizeof(Header) + index(_header().bound + 1, 1, false) * sizeof(std::uint32_t)
+        + (_header().count + 1) * sizeof(std::uint64_t))
+    _release();
+}
+
+inline
+Table::~Table()
+{
+  _release();
+}
+
+inline
+void Table::_release()
+{
+  #if defined(__unix__) || defined(__APPLE__)
+    if (_data)
+      munmap(const_cast<char*>(_data), _size);
+  #endif
+
+  _data = nullptr;
+  _size = 0;
+}
+
+inline
+const Table::Header& Table::_header() const
+{
+  return *reinterpret_cast<const Header*>(_data);
+}
+
+inline
+const std::uint32_t* Table::_cells() const
+{
+  return reinterpret_cast<const std::uint32_t*>(_data + sizeof(Header));
+}
+
+inline
+const std::uint64_t* Table::_offsets() const
+{
+  return reinterpret_cast<const std::uint64_t*>(_cells() + index(bound() + 1, 1, false));
+}
+
+inline
+Table::operator bool() const
+{
+  return _data;
+}
+
+inline
+std::uint64_t Table::bound() const
+{
+  return _data ? _header().bound : 0;
+}
+
+inline
+std::size_t Table::digits(std::uint64_t target, int digit, bool rational) const
+{
+  if (!_data || target > bound())
+    return 0;
+
+  return _cells()[index(target, digit, rational)] & 31;
+}
+
+// The breakdown of an answer and its length, or a null pointer if there is
+// none.  Rational answers are only rendered if they beat integral ones.
+inline
+const char* Table::text(std::uint64_t target, int digit, bool rational, std::size_t& length) const
+{
+  if (!_data || target > bound())
+    return nullptr;
+
+  std::uint64_t breakdown = _cells()[index(target, digit, rational)] >> 5;
+
+  if (!breakdown)
+    return nullptr;
+
+  const char* blob = reinterpret_cast<const char*>(_offsets() + _header().count + 1);
+  std::uint64_t first = _offsets()[breakdown - 1];
+  std::uint64_t last = _offsets()[breakdown];
+
+  if (last > _size - (blob - _data) || first > last)
+    return nullptr;
+
+  length = last - first;
+  return blob + first;
+}
+
+} // namespace Chic
+
+#endif // CHIC_TABLE_HPP
@@ -0,0 +1,418 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_WORKERS_HPP
+#define CHIC_WORKERS_HPP
+
+#include "Dictionary.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <climits>
+#include <cstdint>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Chic {
+
+// Where a threaded build puts its memory: wherever the kernel likes,
+// interleaved across NUMA nodes, or interleaved with each worker's share of
+// the scanned levels moved to the node of that worker.
+enum class Placement { none, interleave, partition };
+
+// Pool of threads for Dictionary::grow(Workers&).  Pinned threads are
+// spread over the CPUs in the order of their nodes, so consecutive threads
+// share a node.  NUMA calls that fail, e.g. outside Linux or without the
+// privilege, leave memory where it is.
+class Workers
+{
+  private:
+    std::vector<std::thread> _threads;
+    std::vector<int> _nodes;
+    unsigned long _online;
+    Placement _placement;
+
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    std::condition_variable _idle;
+    std::function<void(std::size_t)> _job;
+    std::uint_fast64_t _generation;
+    std::size_t _pending;
+    bool _quit;
+
+    static std::vector<int> _list(const std::string&);
+    static std::vector<std::pair<int, int>> _topology();
+    static bool _pin(std::thread&, int);
+    static void _policy(int, unsigned long);
+
+    void _loop(std::size_t);
+
+  public:
+    explicit Workers(std::size_t threads, bool pin = false, Placement = Placement::none);
+    ~Workers();
+
+    Workers(const Workers&) = delete;
+    Workers& operator=(const Workers&) = delete;
+
+    std::size_t size() const;
+    int node(std::size_t) const;
+    Placement placement() const;
+
+    void start(std::function<void(std::size_t)>);
+    void wait();
+
+    void interleave() const;
+    void restore() const;
+    void place(const void*, std::size_t, std::size_t) const;
+};
+
+inline
+std::vector<int> Workers::_list(const std::string& path)
+{
+  std::vector<int> list;
+  std::ifstream stream(path);
+  int first;
+
+  while (stream >> first) {
+    int last = first;
+
+    if (stream.peek() == '-')
+      stream.ignore() >> last;
+
+    for (int k = first; k <= last; ++k)
+      list.push_back(k);
+
+    if (stream.peek() == ',')
+      stream.ignore();
+  }
+
+  return list;
+}
+
+// Pairs of node and CPU, sorted by node
+inline
+std::vector<std::pair<int, int>> Workers::_topology()
+{
+  std::vector<std::pair<int, int>> cpus;
+
+  for (int node: _list("/sys/devices/system/node/online"))
+    for (int cpu: _list("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"))
+      cpus.emplace_back(node, cpu);
+
+  return cpus;
+}
+
+inline
+bool Workers::_pin(std::thread& thread, int cpu)
+{
+#ifdef __linux__
+  cpu_set_t set;
+
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+
+  return !pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+  return false;
+#endif
+}
+
+// Set the memory policy of the calling thread
+inline
+void Workers::_policy(int mode, unsigned long nodes)
+{
+#ifdef __linux__
+  syscall(SYS_set_mempolicy, mode, nodes ? &nodes : nullptr, nodes ? sizeof(nodes) * CHAR_BIT + 1 : 0);
+#endif
+}
+
+inline
+Workers::Workers(std::size_t threads, bool pin, Placement placement)
+  : _nodes(threads, -1),
+    _online(0),
+    _placement(placement),
+    _generation(0),
+    _pending(0),
+    _quit(false)
+{
+  std::vector<std::pair<int, int>> cpus = _topology();
+
+  for (const auto& cpu: cpus)
+    if (cpu.first < int(sizeof(_online) * CHAR_BIT))
+      _online |= 1ul << cpu.first;
+
+  for (std::size_t index = 0; index < threads; ++index) {
+    _threads.emplace_back(&Workers::_loop, this, index);
+
+    if (pin && !cpus.empty()) {
+      const auto& cpu = cpus[index * cpus.size() / threads];
+
+      if (_pin(_threads.back(), cpu.second))
+        _nodes[index] = cpu.first;
+    }
+  }
+}
+
+inline
+Workers::~Workers()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _quit = true;
+  }
+
+  _wake.notify_all();
+
+  for (std::thread& thread: _threads)
+    thread.join();
+}
+
+inline
+void Workers::_loop(std::size_t index)
+{
+  std::uint_fast64_t generation = 0;
+
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _wake.wait(lock, [&] { return _quit || _generation != generation; });
+
+      if (_quit)
+        return;
+
+      generation = _generation;
+    }
+
+    _job(index);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!--_pending)
+      _idle.notify_one();
+  }
+}
+
+inline
+std::size_t Workers::size() const
+{
+  return _threads.size();
+}
+
+// Node the thread is pinned to, or -1 if unknown
+inline
+int Workers::node(std::size_t index) const
+{
+  return _nodes[index];
+}
+
+inline
+Placement Workers::placement() const
+{
+  return _placement;
+}
+
+// Call job(index) on every thread.  The job must not be replaced before
+// wait() returns.
+inline
+void Workers::start(std::function<void(std::size_t)> job)
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _job = std::move(job);
+    _pending = _threads.size();
+    ++_generation;
+  }
+
+  _wake.notify_all();
+}
+
+inline
+void Workers::wait()
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  _idle.wait(lock, [this] { return !_pending; });
+}
+
+// Interleave later allocations of the calling thread across all nodes
+inline
+void Workers::interleave() const
+{
+#ifdef __linux__
+  if (_placement != Placement::none)
+    _policy(MPOL_INTERLEAVE, _online);
+#endif
+}
+
+inline
+void Workers::restore() const
+{
+#ifdef __linux__
+  if (_placement != Placement::none)
+    _policy(MPOL_DEFAULT, 0);
+#endif
+}
+
+// Move the whole pages in [data, data + bytes) to the node of a thread
+inline
+void Workers::place(const void* data, std::size_t bytes, std::size_t index) const
+{
+#ifdef __linux__
+  int node = _nodes[index];
+
+  if (_placement != Placement::partition || node < 0 || node >= int(sizeof(_online) * CHAR_BIT))
+    return;
+
+  std::uintptr_t page = sysconf(_SC_PAGESIZE);
+  std::uintptr_t begin = (reinterpret_cast<std::uintptr_t>(data) + page - 1) & -page;
+  std::uintptr_t end = (reinterpret_cast<std::uintptr_t>(data) + bytes) & -page;
+  unsigned long nodes = 1ul << node;
+
+  if (begin < end)
+    syscall(SYS_mbind, begin, end - begin, MPOL_BIND, &nodes, sizeof(nodes) * CHAR_BIT + 1, MPOL_MF_MOVE);
+#endif
+}
+
+// Sweep the rest of the current length on worker threads.  Each round,
+// worker t computes the candidates of a block of rows against its own slice
+// of ys, which is the part of the level it moves to its node.  Candidates
+// are merged in the order of the serial sweep while the workers compute the
+// next round, so the dictionary is identical to one grown serially.
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+void Dictionary<Key, Monitor, Storage, Policy>::_sweep(const Level& xs, const Level& ys, Workers& workers)
+{
+  const std::size_t slice = 1 << 14;
+  const std::size_t threads = workers.size();
+  const std::size_t rows = (std::max)(threads * slice / (std::max)(ys.size(), std::size_t(1)), std::size_t(1));
+
+  std::vector<std::vector<Candidate>> buffers(2 * threads);
+  std::vector<std::size_t> offsets(2 * threads * (rows + 1));
+
+  std::size_t unlimited = -1;
+
+  _sumset(xs, ys, unlimited);
+
+  for (std::size_t t = 0; t < threads; ++t)
+    workers.place(ys.data() + t * ys.size() / threads, ((t + 1) * ys.size() / threads - t * ys.size() / threads) * sizeof(Key), t);
+
+  auto job = [&](std::size_t bank, std::size_t first, std::size_t last) {
+    return [&, bank, first, last](std::size_t t) {
+      std::vector<Candidate>& buffer = buffers[bank * threads + t];
+      std::size_t* offset = &offsets[(bank * threads + t) * (rows + 1)];
+
+      buffer.clear();
+
+      for (std::size_t i = first; i < last; ++i) {
+        std::size_t split = _overflow(xs[i], ys);
+        std::size_t covered = _covered(xs[i], ys);
+
+        offset[i - first] = buffer.size();
+
+        for (std::size_t j = t * ys.size() / threads; j < (t + 1) * ys.size() / threads; ++j)
+          _combine(Collect(buffer), xs[i], ys[j], j < split, j >= covered);
+      }
+
+      offset[last - first] = buffer.size();
+    };
+  };
+
+  std::size_t bank = 0;
+
+  if (_first < xs.size())
+    workers.start(job(bank, _first, (std::min)(_first + rows, xs.size())));
+
+  for (std::size_t first = _first; first < xs.size(); first += rows, bank ^= 1) {
+    std::size_t last = (std::min)(first + rows, xs.size());
+
+    workers.wait();
+
+    if (last < xs.size())
+      workers.start(job(bank ^ 1, last, (std::min)(last + rows, xs.size())));
+
+    for (std::size_t i = 0; i < last - first; ++i) {
+      for (std::size_t t = 0; t < threads; ++t) {
+        const std::vector<Candidate>& buffer = buffers[bank * threads + t];
+        const std::size_t* offset = &offsets[(bank * threads + t) * (rows + 1)];
+
+        for (std::size_t k = offset[i]; k < offset[i + 1]; ++k) {
+          if (buffer[k].quadratic)
+            _quadratic(buffer[k].key, buffer[k].step);
+          else
+            _basic(buffer[k].key, buffer[k].step);
+        }
+      }
+    }
+
+    _done += (last - first) * ys.size();
+  }
+
+  _first = 0;
+  _second = 0;
+  _span = 0;
+  _sums = Sumset();
+}
+
+// Grow the current level to completion with pairs of keys combined on
+// worker threads.  A watched key does not pause the level.
+template<typename Key, typename Monitor, typename Storage, typename Policy>
+void Dictionary<Key, Monitor, Storage, Policy>::grow(Workers& workers)
+{
+  bool watching = _watching;
+
+  _watching = false;
+  _seen = false;
+  workers.interleave();
+
+  if (!_growing)
+    _open();
+
+  std::size_t size = level();
+
+  for (; _length > 0; --_length) {
+    const Level& xs = _hierarchy[_length - 1];
+    const Level& ys = _hierarchy[size - _length - 1];
+
+    _monitor.start(Phase::pairs, _length);
+
+    if (_second) {
+      std::size_t rest = ys.size() - _second;
+      _sweep<&Dictionary::_binary<Insert>>(xs, ys, rest);
+    }
+
+    _sweep(xs, ys, workers);
+    _monitor.stop(Phase::pairs, _length);
+  }
+
+  grow_some(-1);
+  workers.restore();
+  _watching = watching;
+}
+
+} // namespace Chic
+
+#endif // CHIC_WORKERS_HPP
@@ -0,0 +1,746 @@
+#include "Arena.hpp"
+#include "Breakdown.hpp"
+#include "Buffer.hpp"
+#include "Confirm.hpp"
+#include "Dictionary.hpp"
+#include "Entry.hpp"
+#include "Fraction.hpp"
+#include "Lanes.hpp"
+#include "Operators.hpp"
+#include "Perf.hpp"
+#include "Render.hpp"
+#include "Residue.hpp"
+#include "Ring.hpp"
+#include "Smooth.hpp"
+#include "Statistics.hpp"
+#include "Step.hpp"
+#include "Workers.hpp"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+
+typedef std::chrono::steady_clock Clock;
+
+static const struct
+{
+  std::uint_fast64_t target;
+  std::size_t digits[9];
+}
+corpus[] = {
+  { 1, { 1, 2, 2, 2, 2, 2, 2, 2, 2 } },
+  { 2, { 2, 1, 2, 1, 3, 3, 3, 2, 2 } },
+  { 10, { 3, 4, 4, 3, 2, 4, 4, 3, 3 } },
+  { 24, { 4, 2, 3, 1, 2, 4, 4, 2, 3 } },
+  { 97, { 8, 6, 5, 4, 4, 5, 5, 5, 4 } },
+  { 100, { 5, 5, 4, 3, 4, 4, 6, 4, 4 } },
+  { 127, { 7, 6, 4, 4, 5, 4, 5, 5, 4 } },
+  { 256, { 6, 4, 5, 2, 6, 6, 6, 3, 5 } },
+  { 500, { 8, 6, 5, 5, 5, 6, 7, 6, 4 } },
+  { 720, { 3, 3, 1, 2, 3, 1, 2, 3, 1 } },
+  { 1000, { 6, 6, 5, 4, 4, 5, 7, 5, 4 } },
+  { 1024, { 5, 4, 5, 3, 4, 6, 7, 4, 4 } },
+  { 2016, { 9, 6, 4, 4, 6, 4, 6, 5, 4 } },
+  { 2017, { 10, 8, 6, 6, 7, 6, 7, 7, 5 } },
+  { 3125, { 7, 7, 6, 5, 2, 6, 8, 7, 5 } },
+  { 10000, { 7, 6, 6, 4, 5, 7, 7, 4, 5 } },
+};
+
+static double seconds(Clock::time_point start)
+{
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+template<typename Unsigned>
+static std::string name(Chic::Entry<Unsigned>)
+{
+  return "Entry<uint" + std::to_string(std::numeric_limits<Unsigned>::digits) + ">";
+}
+
+template<typename Unsigned>
+static std::string name(Chic::Fraction<Unsigned>)
+{
+  return "Fraction<uint" + std::to_string(std::numeric_limits<Unsigned>::digits) + ">";
+}
+
+template<typename Key>
+static void grow(std::size_t depth)
+{
+  static const char* const formats[] = { "text", "json", "binary" };
+  const std::string key = name(Key());
+
+  for (int digit = 1; digit <= 9; ++digit) {
+    Clock::time_point start = Clock::now();
+    Chic::Dictionary<Key> dictionary(digit);
+
+    std::cout << "{\"bench\":\"construct\",\"key\":\"" << key << "\",\"digit\":" << digit
+      << ",\"seconds\":" << seconds(start) << "}\n";
+
+    for (std::size_t level = 0; level < depth; ++level) {
+      std::size_t predicted = dictionary.predict();
+
+      start = Clock::now();
+      dictionary.grow();
+
+      std::cout << "{\"bench\":\"grow\",\"key\":\"" << key << "\",\"digit\":" << digit
+        << ",\"level\":" << level + 1 << ",\"keys\":" << dictionary[level].size()
+        << ",\"seconds\":" << seconds(start) << "}\n";
+
+      std::cout << "{\"bench\":\"reservation\",\"key\":\"" << key << "\",\"digit\":" << digit
+        << ",\"level\":" << level + 1 << ",\"predicted\":" << predicted << ",\"keys\":" << dictionary[level].size()
+        << ",\"ratio\":" << double(dictionary[level].size()) / predicted << ",\"bytes\":" << dictionary.bytes() << "}\n";
+    }
+
+    std::ostringstream stream;
+    std::size_t bytes = 0;
+
+    start = Clock::now();
+
+    for (Key target: dictionary[depth - 1]) {
+      dictionary.bfs(target, Chic::breakdown<Key>(stream));
+      bytes += stream.tellp();
+      stream.str(std::string());
+    }
+
+    double elapsed = seconds(start);
+
+    std::cout << "{\"bench\":\"bfs\",\"key\":\"" << key << "\",\"digit\":" << digit
+      << ",\"targets\":" << dictionary[depth - 1].size() << ",\"bytes\":" << bytes
+      << ",\"seconds\":" << elapsed << ",\"per_second\":" << dictionary[depth - 1].size() / elapsed << "}\n";
+
+    for (int format = 0; format < 3; ++format) {
+      std::FILE* file = std::tmpfile();
+
+      {
+        Chic::Buffer buffer(file);
+        std::ostream output(&buffer);
+        Chic::Render<Key> render(output, Chic::Format(format));
+
+        start = Clock::now();
+
+        for (Key target: dictionary[depth - 1]) {
+          render.begin(target, digit, depth);
+          dictionary.template bfs<Chic::Ring<Key>>(target, std::ref(render));
+          render.end();
+        }
+
+        output.flush();
+        elapsed = seconds(start);
+        bytes = output.tellp();
+      }
+
+      std::fclose(file);
+
+      std::cout << "{\"bench\":\"render\",\"key\":\"" << key << "\",\"digit\":" << digit
+        << ",\"format\":\"" << formats[format] << "\",\"targets\":" << dictionary[depth - 1].size() << ",\"bytes\":" << bytes
+        << ",\"seconds\":" << elapsed << ",\"per_second\":" << dictionary[depth - 1].size() / elapsed << "}\n";
+    }
+  }
+}
+
+static bool lanes(std::size_t depth)
+{
+  typedef std::uint64_t Unsigned;
+
+  std::vector<Chic::Dictionary<Chic::Entry<Unsigned>>> dictionaries;
+  Chic::Lanes<Unsigned> engine;
+  bool good = true;
+
+  for (int digit = 1; digit <= 9; ++digit)
+    dictionaries.emplace_back(digit);
+
+  for (std::size_t level = 0; level < depth; ++level) {
+    Clock::time_point start = Clock::now();
+    std::size_t keys = 0;
+
+    for (auto& dictionary: dictionaries) {
+      dictionary.grow();
+      keys += dictionary[level].size();
+    }
+
+    double independent = seconds(start);
+
+    start = Clock::now();
+    engine.grow();
+
+    double together = seconds(start);
+    bool match = true;
+
+    for (int digit = 1; digit <= 9; ++digit)
+      match = match && engine.size(digit, level) == dictionaries[digit - 1][level].size();
+
+    std::cout << "{\"bench\":\"lanes\",\"level\":" << level + 1 << ",\"keys\":" << keys
+      << ",\"rows\":" << engine[level].size() << ",\"occupancy\":" << double(keys) / (engine[level].size() * engine.width)
+      << ",\"independent\":" << independent << ",\"lanes\":" << together << ",\"speedup\":" << independent / together
+      << ",\"match\":" << (match ? "true" : "false") << "}\n";
+
+    good = good && match;
+  }
+
+  return good;
+}
+
+// Grow the same dictionary serially and on workers with each placement, and
+// check that every level comes out identical.
+template<typename Key>
+static bool threads(std::size_t depth, std::size_t count, int digit)
+{
+  static const char* const placements[] = { "none", "interleave", "partition" };
+  static const struct
+  {
+    bool pin;
+    Chic::Placement placement;
+  }
+  options[] = {
+    { false, Chic::Placement::none },
+    { true, Chic::Placement::none },
+    { true, Chic::Placement::interleave },
+    { true, Chic::Placement::partition },
+  };
+
+  const std::string key = name(Key());
+  Chic::Dictionary<Key> serial(digit);
+  Clock::time_point start = Clock::now();
+
+  for (std::size_t level = 0; level < depth; ++level)
+    serial.grow();
+
+  double elapsed = seconds(start);
+  std::size_t keys = 0;
+
+  for (std::size_t level = 0; level < depth; ++level)
+    keys += serial[level].size();
+
+  std::cout << "{\"bench\":\"threads\",\"key\":\"" << key << "\",\"digit\":" << digit << ",\"depth\":" << depth
+    << ",\"threads\":0,\"keys\":" << keys << ",\"seconds\":" << elapsed << ",\"per_second\":" << keys / elapsed << "}\n";
+
+  bool good = true;
+
+  for (const auto& option: options) {
+    Chic::Workers workers(count, option.pin, option.placement);
+    Chic::Dictionary<Key> dictionary(digit);
+    bool match = true;
+
+    start = Clock::now();
+
+    for (std::size_t level = 0; level < depth; ++level)
+      dictionary.grow(workers);
+
+    elapsed = seconds(start);
+
+    for (std::size_t level = 0; level < depth; ++level)
+      match = match && dictionary[level] == serial[level];
+
+    std::cout << "{\"bench\":\"threads\",\"key\":\"" << key << "\",\"digit\":" << digit << ",\"depth\":" << depth
+      << ",\"threads\":" << count << ",\"pinned\":" << (option.pin ? "true" : "false")
+      << ",\"placement\":\"" << placements[int(option.placement)] << "\",\"keys\":" << keys
+      << ",\"seconds\":" << elapsed << ",\"per_second\":" << keys / elapsed << ",\"match\":" << (match ? "true" : "false") << "}\n";
+
+    good = good && match;
+  }
+
+  return good;
+}
+
+static std::uint_fast64_t misses(const Chic::Perf& perf)
+{
+  std::uint_fast64_t total = 0;
+
+  for (const auto& sample: perf.samples())
+    total += sample.counts[Chic::Perf::tlb];
+
+  return total;
+}
+
+// Grow the same dictionary on the heap and in an arena, and count the
+// allocation calls and TLB misses of each.
+template<typename Key>
+static bool arena(std::size_t depth, int digit)
+{
+  const std::string key = name(Key());
+  Clock::time_point start = Clock::now();
+  Chic::Dictionary<Key, Chic::Perf> heap(digit);
+
+  for (std::size_t level = 0; level < depth; ++level)
+    heap.grow();
+
+  double elapsed = seconds(start);
+  bool available = heap.monitor().available(Chic::Perf::tlb);
+
+  std::cout << "{\"bench\":\"arena\",\"key\":\"" << key << "\",\"digit\":" << digit << ",\"depth\":" << depth
+    << ",\"storage\":\"heap\",\"seconds\":" << elapsed << ",\"tlb\":";
+
+  (available ? std::cout << misses(heap.monitor()) : std::cout << "null") << "}\n";
+
+  start = Clock::now();
+  Chic::Dictionary<Key, Chic::Perf, Chic::Arena> arena(digit);
+
+  for (std::size_t level = 0; level < depth; ++level)
+    arena.grow();
+
+  elapsed = seconds(start);
+  bool match = true;
+
+  for (std::size_t level = 0; level < depth; ++level)
+    match = match && arena[level].size() == heap[level].size() && std::equal(arena[level].begin(), arena[level].end(), heap[level].begin());
+
+  std::cout << "{\"bench\":\"arena\",\"key\":\"" << key << "\",\"digit\":" << digit << ",\"depth\":" << depth
+    << ",\"storage\":\"arena\",\"seconds\":" << elapsed << ",\"tlb\":";
+
+  (available ? std::cout << misses(arena.monitor()) : std::cout << "null")
+    << ",\"allocations\":" << arena.storage().allocations() << ",\"chunks\":" << arena.storage().chunks()
+    << ",\"huge\":" << arena.storage().huge() << ",\"bytes\":" << arena.storage().bytes()
+    << ",\"match\":" << (match ? "true" : "false") << "}\n";
+
+  return match;
+}
+
+// Look up complements T - x of corpus targets, which are mostly absent,
+// with and without the filters of the dictionary.
+template<typename Key>
+static bool filter(std::size_t depth, int digit)
+{
+  const std::string key = name(Key());
+  Chic::Dictionary<Key, Chic::Statistics> dictionary(digit);
+
+  for (std::size_t level = 0; level < depth; ++level)
+    dictionary.grow();
+
+  std::size_t hits = 0;
+  std::size_t lookups = 0;
+  Clock::time_point start = Clock::now();
+
+  for (const auto& entry: corpus)
+    for (std::size_t level = 0; level < depth; ++level)
+      for (Key x: dictionary[level])
+        hits += bool(dictionary.digits(Key(entry.target) - x));
+
+  double unfiltered = seconds(start);
+
+  start = Clock::now();
+
+  for (const auto& entry: corpus) {
+    for (std::size_t level = 0; level < depth; ++level) {
+      for (Key x: dictionary[level]) {
+        hits -= dictionary.contains(Key(entry.target) - x);
+        ++lookups;
+      }
+    }
+  }
+
+  double filtered = seconds(start);
+  const Chic::Statistics::Lookups& counts = dictionary.monitor().lookups();
+  std::size_t absent = counts.avoided + counts.positives;
+
+  std::cout << "{\"bench\":\"filter\",\"key\":\"" << key << "\",\"digit\":" << digit << ",\"depth\":" << depth
+    << ",\"lookups\":" << lookups << ",\"avoided\":" << counts.avoided << ",\"positives\":" << counts.positives
+    << ",\"rate\":" << double(counts.positives) / absent << ",\"unfiltered\":" << unfiltered << ",\"filtered\":" << filtered
+    << ",\"match\":" << (hits ? "false" : "true") << "}\n";
+
+  return !hits;
+}
+
+// Grow integral dictionaries with and without the dense tier, and look up
+// every small integer in both.
+static bool dense(std::size_t depth, int digit)
+{
+  typedef Chic::Entry<std::uint64_t> Key;
+
+  const std::uintmax_t bound = 1 << 26;
+  const std::uint64_t queries = 1 << 20;
+
+  Chic::Dictionary<Key> hashed(digit);
+  Chic::Dictionary<Key> indexed(digit);
+  Clock::time_point start = Clock::now();
+
+  for (std::size_t level = 0; level < depth; ++level)
+    hashed.grow();
+
+  double growth[2] = { seconds(start) };
+
+  start = Clock::now();
+  indexed.dense(bound);
+
+  for (std::size_t level = 0; level < depth; ++level)
+    indexed.grow();
+
+  growth[1] = seconds(start);
+
+  std::size_t sums[2] = {};
+  double lookups[2];
+
+  start = Clock::now();
+
+  for (std::uint64_t value = 1; value < queries; ++value)
+    sums[0] += hashed.digits(value);
+
+  lookups[0] = seconds(start);
+  start = Clock::now();
+
+  for (std::uint64_t value = 1; value < queries; ++value)
+    sums[1] += indexed.digits(value);
+
+  lookups[1] = seconds(start);
+
+  std::uint64_t unreachable = 1;
+
+  while (hashed.contains(unreachable))
+    ++unreachable;
+
+  bool match = sums[0] == sums[1] && unreachable == indexed.unreachable();
+
+  for (std::size_t level = 0; level < depth; ++level)
+    match = match && hashed[level] == indexed[level];
+
+  std::cout << "{\"bench\":\"dense\",\"digit\":" << digit << ",\"depth\":" << depth << ",\"bound\":" << bound
+    << ",\"grow\":{\"hashed\":" << growth[0] << ",\"dense\":" << growth[1] << "},\"lookups\":{\"hashed\":" << lookups[0]
+    << ",\"dense\":" << lookups[1] << "},\"bytes\":{\"hashed\":" << hashed.bytes() << ",\"dense\":" << indexed.bytes()
+    << "},\"unreachable\":" << indexed.unreachable() << ",\"match\":" << (match ? "true" : "false") << "}\n";
+
+  return match;
+}
+
+// Grow dictionaries of fractions and of smooth keys, which factor the same
+// values over small primes, and check that every fraction is a smooth key
+// with at most as many digits.  Both kinds of keys are reduced, so the
+// dictionaries hold the same values.
+static bool smooth(std::size_t depth, int digit)
+{
+  typedef Chic::Fraction<std::uint64_t> Fraction;
+  typedef Chic::Smooth<std::uint64_t> Smooth;
+
+  Chic::Dictionary<Fraction> fractions(digit);
+  Chic::Dictionary<Smooth> smooths(digit);
+  Clock::time_point start = Clock::now();
+
+  for (std::size_t level = 0; level < depth; ++level)
+    fractions.grow();
+
+  double fraction = seconds(start);
+
+  start = Clock::now();
+
+  for (std::size_t level = 0; level < depth; ++level)
+    smooths.grow();
+
+  double smooth = seconds(start);
+  std::size_t sizes[2] = {};
+  std::size_t missing = 0;
+
+  for (std::size_t level = 0; level < depth; ++level) {
+    sizes[0] += fractions[level].size();
+    sizes[1] += smooths[level].size();
+
+    for (Fraction key: fractions[level]) {
+      std::size_t digits = smooths.digits(Smooth(key));
+      missing += !digits || digits > level + 1;
+    }
+  }
+
+  std::cout << "{\"bench\":\"smooth\",\"digit\":" << digit << ",\"depth\":" << depth
+    << ",\"keys\":{\"fraction\":" << sizes[0] << ",\"smooth\":" << sizes[1] << "},\"seconds\":{\"fraction\":" << fraction
+    << ",\"smooth\":" << smooth << "},\"missing\":" << missing << "}\n";
+
+  return !missing;
+}
+
+// Estimate every level before growing it, and compare with the level grown.
+template<typename Key>
+static void estimate(std::size_t depth, int digit)
+{
+  const std::string key = name(Key());
+  Chic::Dictionary<Key> dictionary(digit);
+
+  for (std::size_t level = 0; level < depth; ++level) {
+    Clock::time_point start = Clock::now();
+    Chic::Estimate estimate = dictionary.estimate();
+    double sampling = seconds(start);
+
+    start = Clock::now();
+    dictionary.grow();
+
+    std::cout << "{\"bench\":\"estimate\",\"key\":\"" << key << "\",\"digit\":" << digit << ",\"level\":" << level + 1
+      << ",\"keys\":{\"estimate\":" << estimate.keys << ",\"actual\":" << dictionary[level].size()
+      << "},\"bytes\":{\"estimate\":" << estimate.bytes << ",\"actual\":" << dictionary.bytes()
+      << "},\"seconds\":{\"estimate\":" << estimate.seconds << ",\"actual\":" << seconds(start) << ",\"sampling\":" << sampling << "}}\n";
+  }
+}
+
+// Grow dictionaries whose operator sets are fixed at compile time.
+template<typename Policy>
+static void operators(std::size_t depth, int digit, const char* policy)
+{
+  typedef Chic::Entry<std::uint64_t> Key;
+
+  Chic::Dictionary<Key, Chic::Silent, Chic::Heap, Policy> dictionary(digit);
+  Clock::time_point start = Clock::now();
+  std::size_t keys = 0;
+
+  for (std::size_t level = 0; level < depth; ++level) {
+    dictionary.grow();
+    keys += dictionary[level].size();
+  }
+
+  double elapsed = seconds(start);
+
+  std::cout << "{\"bench\":\"operators\",\"policy\":\"" << policy << "\",\"digit\":" << digit << ",\"depth\":" << depth
+    << ",\"keys\":" << keys << ",\"seconds\":" << elapsed << ",\"per_second\":" << keys / elapsed << "}\n";
+}
+
+// Look up the corpus in dictionaries of residues, which keep intermediates
+// beyond machine width, and confirm every answer exactly.
+static void residue(std::size_t depth)
+{
+  for (int digit = 1; digit <= 9; ++digit) {
+    Clock::time_point start = Clock::now();
+    Chic::Dictionary<Chic::Residue> dictionary(digit);
+
+    for (std::size_t level = 0; level < depth; ++level)
+      dictionary.grow();
+
+    double elapsed = seconds(start);
+    std::size_t keys = 0;
+    std::size_t shorter = 0;
+    std::size_t missed = 0;
+    std::size_t found = 0;
+    std::size_t confirmed = 0;
+
+    for (std::size_t level = 0; level < depth; ++level)
+      keys += dictionary[level].size();
+
+    for (const auto& entry: corpus) {
+      std::size_t expected = entry.digits[digit - 1];
+      std::size_t actual = dictionary.digits(entry.target);
+
+      found += !!actual;
+      confirmed += actual && Chic::confirm(dictionary, entry.target, Chic::Big(entry.target));
+
+      if (actual && actual < expected) {
+        std::cout << "{\"bench\":\"residue\",\"target\":" << entry.target << ",\"digit\":" << digit
+          << ",\"expected\":" << expected << ",\"actual\":" << actual << "}\n";
+        ++shorter;
+      }
+
+      missed += expected <= depth && actual != expected;
+    }
+
+    std::cout << "{\"bench\":\"residue\",\"digit\":" << digit << ",\"depth\":" << depth
+      << ",\"keys\":" << keys << ",\"shorter\":" << shorter << ",\"missed\":" << missed
+      << ",\"found\":" << found << ",\"confirmed\":" << confirmed << ",\"seconds\":" << elapsed << "}\n";
+  }
+}
+
+static std::size_t solve(std::uint_fast64_t target, int digit, std::uintmax_t magnitude = -1, std::uintmax_t denominator = -1)
+{
+  typedef std::uint_fast64_t Unsigned;
+  std::size_t integral = 0;
+
+  {
+    Chic::Dictionary<Chic::Entry<Unsigned>> dictionary(digit);
+    dictionary.prune(magnitude, denominator);
+    dictionary.build(target);
+    integral = dictionary.level();
+  }
+
+  Chic::Dictionary<Chic::Fraction<Unsigned>> dictionary(digit);
+  dictionary.prune(magnitude, denominator);
+  return dictionary.build(target, integral) ? dictionary.level() : integral;
+}
+
+static bool golden()
+{
+  bool pass = true;
+
+  for (const auto& entry: corpus) {
+    for (int digit = 1; digit <= 9; ++digit) {
+      Clock::time_point start = Clock::now();
+      std::size_t rational = solve(entry.target, digit);
+      bool match = rational == entry.digits[digit - 1];
+      pass = pass && match;
+
+      std::cout << "{\"bench\":\"golden\",\"target\":" << entry.target << ",\"digit\":" << digit
+        << ",\"expected\":" << entry.digits[digit - 1] << ",\"actual\":" << rational
+        << ",\"match\":" << (match ? "true" : "false") << ",\"seconds\":" << seconds(start) << "}\n";
+    }
+  }
+
+  return pass;
+}
+
+static void prune()
+{
+  static const struct
+  {
+    std::uintmax_t magnitude;
+    std::uintmax_t denominator;
+  }
+  policies[] = {
+    { std::uintmax_t(1) << 32, std::uintmax_t(-1) },
+    { std::uintmax_t(1) << 20, std::uintmax_t(-1) },
+    { std::uintmax_t(1) << 20, 1 << 10 },
+  };
+
+  for (const auto& policy: policies) {
+    Clock::time_point start = Clock::now();
+    std::size_t changed = 0;
+    std::size_t total = 0;
+
+    for (const auto& entry: corpus) {
+      for (int digit = 1; digit <= 9; ++digit) {
+        std::size_t digits = solve(entry.target, digit, policy.magnitude, policy.denominator);
+
+        if (digits != entry.digits[digit - 1]) {
+          std::cout << "{\"bench\":\"prune\",\"magnitude\":" << policy.magnitude << ",\"denominator\":" << policy.denominator
+            << ",\"target\":" << entry.target << ",\"digit\":" << digit
+            << ",\"expected\":" << entry.digits[digit - 1] << ",\"actual\":" << digits << "}\n";
+          ++changed;
+        }
+
+        ++total;
+      }
+    }
+
+    std::cout << "{\"bench\":\"prune\",\"magnitude\":" << policy.magnitude << ",\"denominator\":" << policy.denominator
+      << ",\"answers\":" << total << ",\"changed\":" << changed << ",\"seconds\":" << seconds(start) << "}\n";
+  }
+}
+
+static int usage(const char* program)
+{
+  std::cout << "Usage: " << program << " [-d DEPTH] [-j THREADS] [SECTION...]\n\n"
+    "-d DEPTH    Levels to grow in every section but golden and prune (default: 5)\n"
+    "-j THREADS  Workers in the threads section (default: all CPUs)\n"
+    "SECTION     grow, golden, prune, lanes, threads, arena, filter,\n"
+    "            residue, dense, smooth, estimate or operators\n"
+    "            (default: grow and golden)\n"
+    "\n"
+    "Results are printed as one JSON object per line.\n"
+    "The exit status is nonzero if any golden answer changes or any\n"
+    "section finds a mismatch.\n";
+
+  return 2;
+}
+
+// A section runs benchmarks at a depth with a number of workers, and
+// returns false if it finds a regression.
+struct Section
+{
+  const char* name;
+  bool (*run)(std::size_t depth, std::size_t count);
+};
+
+static const Section sections[] = {
+  { "grow", [](std::size_t depth, std::size_t) {
+    grow<Chic::Entry<std::uint32_t>>(depth);
+    grow<Chic::Entry<std::uint64_t>>(depth);
+    grow<Chic::Fraction<std::uint32_t>>(depth);
+    grow<Chic::Fraction<std::uint64_t>>(depth);
+    return true;
+  } },
+  { "prune", [](std::size_t, std::size_t) {
+    prune();
+    return true;
+  } },
+  { "lanes", [](std::size_t depth, std::size_t) {
+    return lanes(depth);
+  } },
+  { "threads", [](std::size_t depth, std::size_t count) {
+    bool good = threads<Chic::Entry<std::uint64_t>>(depth, count, 3);
+    return threads<Chic::Fraction<std::uint64_t>>(depth, count, 3) && good;
+  } },
+  { "arena", [](std::size_t depth, std::size_t) {
+    bool good = arena<Chic::Entry<std::uint64_t>>(depth, 3);
+    return arena<Chic::Fraction<std::uint64_t>>(depth, 3) && good;
+  } },
+  { "filter", [](std::size_t depth, std::size_t) {
+    bool good = filter<Chic::Entry<std::uint64_t>>(depth, 3);
+    return filter<Chic::Fraction<std::uint64_t>>(depth, 3) && good;
+  } },
+  { "residue", [](std::size_t depth, std::size_t) {
+    residue(depth);
+    return true;
+  } },
+  { "dense", [](std::size_t depth, std::size_t) {
+    return dense(depth, 9);
+  } },
+  { "smooth", [](std::size_t depth, std::size_t) {
+    bool good = smooth(depth, 3);
+    return smooth(depth, 9) && good;
+  } },
+  { "estimate", [](std::size_t depth, std::size_t) {
+    estimate<Chic::Entry<std::uint64_t>>(depth, 9);
+    estimate<Chic::Fraction<std::uint64_t>>(depth, 3);
+    return true;
+  } },
+  { "operators", [](std::size_t depth, std::size_t) {
+    using Chic::mask;
+    using Chic::Operator;
+
+    const unsigned factorials = mask(Operator::factorial) | mask(Operator::quotient) | mask(Operator::neighbor);
+    const unsigned arithmetic = mask(Operator::concatenation) | mask(Operator::addition) | mask(Operator::subtraction)
+      | mask(Operator::multiplication) | mask(Operator::division);
+
+    operators<Chic::Operators<>>(depth, 9, "all");
+    operators<Chic::Operators<Chic::tchisla & ~factorials>>(depth, 9, "no factorials");
+    operators<Chic::Operators<Chic::tchisla & ~mask(Operator::power)>>(depth, 9, "no powers");
+    operators<Chic::Operators<arithmetic>>(depth, 9, "arithmetic");
+    return true;
+  } },
+  { "golden", [](std::size_t, std::size_t) {
+    return golden();
+  } },
+};
+
+int main(int argc, char** argv)
+{
+  std::ios_base::sync_with_stdio(false);
+
+  const std::size_t size = sizeof(sections) / sizeof(*sections);
+
+  std::size_t depth = 5;
+  std::size_t count = (std::max)(std::thread::hardware_concurrency(), 1u);
+  std::vector<bool> selected(size);
+  int index = 1;
+
+  for (; index < argc && argv[index][0] == '-'; ++index) {
+    if (argv[index] == std::string("-d") && index + 1 < argc)
+      std::istringstream(argv[++index]) >> depth;
+    else if (argv[index] == std::string("-j") && index + 1 < argc)
+      std::istringstream(argv[++index]) >> count;
+    else
+      return usage(*argv);
+  }
+
+  for (; index < argc; ++index) {
+    std::size_t k = 0;
+
+    while (k < size && argv[index] != std::string(sections[k].name))
+      ++k;
+
+    if (k == size)
+      return usage(*argv);
+
+    selected[k] = true;
+  }
+
+  if (!depth || !count)
+    return usage(*argv);
+
+  if (std::find(selected.begin(), selected.end(), true) == selected.end())
+    for (std::size_t k = 0; k < size; ++k)
+      selected[k] = sections[k].name == std::string("grow") || sections[k].name == std::string("golden");
+
+  bool good = true;
+
+  for (std::size_t k = 0; k < size; ++k)
+    if (selected[k])
+      good = sections[k].run(depth, count) && good;
+
+  return !good;
+}
@@ -1,12 +1,31 @@
-#include "Breakdown.hpp"
+#include "Anytime.hpp"
+#include "Buffer.hpp"
+#include "Deepening.hpp"
 #include "Dictionary.hpp"
 #include "Entry.hpp"
 #include "Fraction.hpp"
+#include "Perf.hpp"
+#include "Render.hpp"
+#include "Ring.hpp"
+#include "Statistics.hpp"
 #include "Step.hpp"
+#include "Table.hpp"
+#include <algorithm>
+#include <chrono>
+#include <functional>
 #include <iostream>
 #include <sstream>
 #include <cstdint>
 
+struct Options
+{
+  std::size_t memory;
+  double deadline;
+  Chic::Format format;
+  std::uintmax_t magnitude;
+  std::uintmax_t denominator;
+};
+
 template<typename Unsigned>
 static const char* message(Chic::Entry<Unsigned>)
 {
@@ -21,50 +40,255 @@ static const char* message(Chic::Fraction<Unsigned>)
   return value;
 }
 
-template<typename Key, typename Unsigned>
-static std::size_t find(Unsigned target, int digit, std::size_t limit = -1)
+template<typename Key>
+static void report(const Chic::Dictionary<Key>&)
+{}
+
+// Filter lookups, which only Statistics counts
+static void lookups(const Chic::Perf&)
+{}
+
+static void lookups(const Chic::Statistics& statistics)
+{
+  const Chic::Statistics::Lookups& lookups = statistics.lookups();
+
+  std::clog << ",\"filter\":{\"probes\":" << lookups.probes << ",\"avoided\":" << lookups.avoided
+    << ",\"positives\":" << lookups.positives << '}';
+}
+
+template<typename Key, typename Monitor>
+static void report(const Chic::Dictionary<Key, Monitor>& dictionary)
 {
-  Chic::Dictionary<Key> dictionary(digit);
+  std::clog << "{\"digit\":" << dictionary.digit << ",\"domain\":\"" << message(Key())[4] << "\",\"levels\":";
+  Chic::json(std::clog, dictionary.monitor());
+  lookups(dictionary.monitor());
+  std::clog << "}\n";
+}
+
+template<typename Key, typename Monitor, typename Unsigned>
+static std::size_t find(Unsigned target, int digit, const Options& options, std::size_t limit = -1)
+{
+  Chic::Dictionary<Key, Monitor> dictionary(digit);
+
+  dictionary.cap(options.memory);
+  dictionary.prune(options.magnitude, options.denominator);
+
+  bool found = dictionary.build(target, limit);
+
+  report(dictionary);
+
+  Chic::Render<Key> render(std::cout, options.format);
+
+  if (dictionary.full()) {
+    (options.format == Chic::Format::text ? std::cout : std::clog) << target << '#' << digit << message(Key())
+      << "memory limit reached at " << dictionary.level() << " digits\n" << std::endl;
 
-  if (dictionary.build(target, limit)) {
-    std::cout << target << '#' << digit << message(Key()) << dictionary.level() << " digits\n"
-      "--------------------\n";
-    dictionary.bfs(target, Chic::breakdown<Key>(std::cout));
-    std::cout << std::endl;
+    Chic::Deepening<Key, Monitor> deepening(dictionary);
+
+    if (std::size_t digits = deepening.search(target, std::min(limit, 2 * dictionary.level() + 2))) {
+      render.begin(target, digit, digits, "upper bound");
+      deepening.bfs(target, std::ref(render));
+      render.end();
+      std::cout << std::flush;
+      return digits;
+    }
+  }
+
+  if (found) {
+    render.begin(target, digit, dictionary.level(), dictionary.pruned() ? "upper bound" : nullptr);
+    dictionary.template bfs<Chic::Ring<Key>>(target, std::ref(render));
+    render.end();
+    std::cout << std::flush;
     return dictionary.level();
   }
 
   return limit;
 }
 
-template<typename Unsigned>
-static void find(Unsigned target, int digit)
+template<typename Key, typename Monitor, typename Unsigned>
+static std::size_t anytime(Unsigned target, int digit, const Options& options, std::size_t limit = -1)
+{
+  typedef std::chrono::steady_clock Clock;
+
+  const std::size_t warm = 4;
+  const std::size_t budget = 1 << 20;
+
+  Clock::time_point deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.deadline));
+  Chic::Dictionary<Key, Monitor> dictionary(digit);
+  Chic::Bound<Key> bound(target);
+  Chic::Render<Key> render(std::cout, options.format);
+
+  dictionary.cap(options.memory);
+  dictionary.prune(options.magnitude, options.denominator);
+  Chic::refine(dictionary, Key(target), warm + 1, deadline);
+  bound.search(dictionary, budget);
+
+  bool bounded = bound && bound.digits() < limit;
+
+  if (bounded) {
+    render.begin(target, digit, bound.digits(), "upper bound");
+    bound.bfs(dictionary, std::ref(render));
+    render.end();
+    std::cout << std::flush;
+    limit = bound.digits();
+  }
+
+  bool proven = Chic::refine(dictionary, Key(target), limit, deadline) && !dictionary.pruned();
+
+  report(dictionary);
+
+  if (std::size_t digits = dictionary.digits(target)) {
+    if (digits < limit) {
+      render.begin(target, digit, digits, dictionary.pruned() ? "upper bound" : "proven optimal");
+      dictionary.template bfs<Chic::Ring<Key>>(target, std::ref(render));
+      render.end();
+      std::cout << std::flush;
+      return digits;
+    }
+  }
+
+  if (bounded && options.format == Chic::Format::text)
+    std::cout << target << '#' << digit << message(Key()) << limit << (proven ? " digits (proven optimal)\n" : " digits (best found)\n") << std::endl;
+
+  if (bounded && options.format != Chic::Format::text) {
+    render.begin(target, digit, limit, proven ? "proven optimal" : "best found");
+    render.end();
+    std::cout << std::flush;
+  }
+
+  return limit;
+}
+
+template<typename Key, typename Unsigned>
+static void print(const Chic::Table& table, Unsigned target, int digit)
 {
-  find<Chic::Fraction<Unsigned>>(target, digit, find<Chic::Entry<Unsigned>>(target, digit));
+  const bool rational = std::is_same<Key, Chic::Fraction<Unsigned>>::value;
+  std::size_t length = 0;
+  const char* text = table.text(target, digit, rational, length);
+
+  std::cout << target << '#' << digit << message(Key()) << table.digits(target, digit, rational) << " digits\n"
+    "--------------------\n";
+  std::cout.write(text, length) << std::endl;
 }
 
+// Answer from the table, with the rational answer alone if no integral one
+// is within its depth
 template<typename Unsigned>
-static void run(Unsigned target)
+static bool lookup(const Chic::Table& table, Unsigned target, int digit)
+{
+  std::size_t integral = table.digits(target, digit, false);
+  std::size_t rational = table.digits(target, digit, true);
+
+  if (integral)
+    print<Chic::Entry<Unsigned>>(table, target, digit);
+
+  if (rational && (!integral || rational < integral))
+    print<Chic::Fraction<Unsigned>>(table, target, digit);
+
+  return integral || rational;
+}
+
+template<typename Monitor, typename Unsigned>
+static void find(Unsigned target, int digit, const Options& options)
+{
+  if (options.deadline)
+    anytime<Chic::Fraction<Unsigned>, Monitor>(target, digit, options, anytime<Chic::Entry<Unsigned>, Monitor>(target, digit, options));
+  else
+    find<Chic::Fraction<Unsigned>, Monitor>(target, digit, options, find<Chic::Entry<Unsigned>, Monitor>(target, digit, options));
+}
+
+template<typename Monitor, typename Unsigned>
+static void run(Unsigned target, const Chic::Table& table, const Options& options)
 {
   for (int digit = 1; digit <= 9; ++digit)
-    find(target, digit);
+    if (options.format != Chic::Format::text || !lookup(table, target, digit))
+      find<Monitor>(target, digit, options);
+}
+
+static bool parse(const std::string& name, Chic::Format& format)
+{
+  static const char* const names[] = { "text", "json", "binary" };
+
+  for (int k = 0; k < 3; ++k) {
+    if (name == names[k]) {
+      format = Chic::Format(k);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static int usage(const char* program)
+{
+  std::cout << "Usage: " << program << " [-b BOUND] [-q BOUND] [-d SECONDS] [-f FORMAT] [-m BYTES] [-p | -s] [-t TABLE] TARGET\n\n"
+    "-b BOUND    Prune keys whose numerator or denominator exceeds BOUND\n"
+    "-q BOUND    Prune fractions whose denominator exceeds BOUND\n"
+    "-d SECONDS  Print an upper bound first, then refine it for this long per dictionary\n"
+    "-f FORMAT   Print answers as text, json or binary records (default: text)\n"
+    "-m BYTES    Search depth-first once a dictionary would exceed this size\n"
+    "-p          Print hardware counters of each dictionary as JSON to stderr\n"
+    "-s          Print build statistics of each dictionary as JSON to stderr\n"
+    "-t TABLE    Answer from a precomputed table when printing text\n"
+    "TARGET      The result to make\n"
+    "\n"
+    "Answers found while pruning are only upper bounds.\n\n"
+    "Syntactically correct but numerically invalid input\n"
+    "causes undefined behavior.\n";
+
+  return 1;
 }
 
 int main(int argc, char** argv)
 {
   std::ios_base::sync_with_stdio(false);
 
-  if (argc == 2) {
-    std::istringstream stream(argv[1]);
-    std::uint_fast64_t target;
-    stream >> target;
-    run(target);
+  const char* table = "";
+  char monitor = 0;
+  Options options = { std::size_t(-1), 0, Chic::Format::text, std::uintmax_t(-1), std::uintmax_t(-1) };
+  int index = 1;
+
+  for (; index < argc && argv[index][0] == '-'; ++index) {
+    if (argv[index] == std::string("-p") || argv[index] == std::string("-s"))
+      monitor = argv[index][1];
+    else if (argv[index] == std::string("-b") && index + 1 < argc)
+      std::istringstream(argv[++index]) >> options.magnitude;
+    else if (argv[index] == std::string("-q") && index + 1 < argc)
+      std::istringstream(argv[++index]) >> options.denominator;
+    else if (argv[index] == std::string("-d") && index + 1 < argc)
+      std::istringstream(argv[++index]) >> options.deadline;
+    else if (argv[index] == std::string("-f") && index + 1 < argc) {
+      if (!parse(argv[++index], options.format))
+        return usage(*argv);
+    }
+    else if (argv[index] == std::string("-m") && index + 1 < argc)
+      std::istringstream(argv[++index]) >> options.memory;
+    else if (argv[index] == std::string("-t") && index + 1 < argc)
+      table = argv[++index];
+    else
+      return usage(*argv);
   }
-  else {
-    std::cout << "Usage: " << argv[0] << " TARGET\n\n"
-      "TARGET  The result to make\n"
-      "\n"
-      "Syntactically correct but numerically invalid input\n"
-      "causes undefined behavior.\n";
+
+  if (index + 1 != argc)
+    return usage(*argv);
+
+  std::istringstream stream(argv[index]);
+  std::uint_fast64_t target;
+  stream >> target;
+
+  Chic::Buffer buffer(stdout);
+  std::streambuf* standard = std::cout.rdbuf(&buffer);
+
+  switch (monitor) {
+    case 'p':
+      run<Chic::Perf>(target, Chic::Table(table), options);
+      break;
+    case 's':
+      run<Chic::Statistics>(target, Chic::Table(table), options);
+      break;
+    default:
+      run<Chic::Silent>(target, Chic::Table(table), options);
   }
+
+  std::cout.rdbuf(standard);
 }
@@ -0,0 +1,73 @@
+// This file is part of Chic, a Tchisla solver.
+//
+// Copyright (C) 2016 Chen-Pang He <https://jdh8.org/>
+//
+// Chic is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// Chic is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#ifndef CHIC_H
+#define CHIC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// C interface to resident dictionaries, built from libchic.cpp as a shared
+// library.  A dictionary answers any number of concurrent readers, and calls
+// that grow it wait for them.  The library writes only into buffers the
+// caller provides and never hands out memory to free.
+
+#define CHIC_VERSION 1
+
+typedef struct chic_dictionary chic_dictionary;
+
+// Domains of keys
+enum { CHIC_INTEGER, CHIC_RATIONAL };
+
+// Formats of breakdowns, as in `chic -f`
+enum { CHIC_TEXT, CHIC_JSON, CHIC_BINARY };
+
+int chic_version(void);
+
+// Create an empty dictionary of a digit from 1 to 9 in a domain, or return
+// NULL on failure
+chic_dictionary* chic_create(int digit, int domain);
+void chic_destroy(chic_dictionary*);
+
+// Grow `levels` more levels.  Return the number of levels, or -1 on failure,
+// such as running out of memory.  Failure of this or any other call is fatal
+// to the dictionary: from then on it has no levels, finds no targets, and can
+// only be destroyed.  The call that fails returns -1 or 0, and stores 0 for
+// every digit count.
+int chic_grow(chic_dictionary*, size_t levels);
+size_t chic_level(const chic_dictionary*);
+
+// Store the digit counts of `count` integral targets, 0 for those not found
+// in the levels grown so far
+void chic_digits(const chic_dictionary*, const uint64_t* targets, size_t count, size_t* digits);
+
+// Write the breakdown of a target in a format to a buffer of `size` bytes.
+// Like snprintf, text and JSON are always terminated by a null character if
+// `size` is nonzero.  Return the size of the whole breakdown without the
+// terminator, which is at least `size` if the output is truncated, or 0 if
+// the target is not found.
+size_t chic_breakdown(const chic_dictionary*, uint64_t target, int format, char* buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CHIC_H
@@ -0,0 +1,116 @@
+#include "Buffer.hpp"
+#include "Columnar.hpp"
+#include "Dictionary.hpp"
+#include "Entry.hpp"
+#include "Fraction.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+
+template<typename Key>
+static bool write(const char* path, int digit, std::size_t depth, bool compress)
+{
+  Chic::Dictionary<Key> dictionary(digit);
+  std::FILE* file = std::fopen(path, "wb");
+
+  if (!file)
+    return false;
+
+  for (std::size_t level = 0; level < depth; ++level)
+    dictionary.grow();
+
+  bool good;
+
+  {
+    Chic::Buffer buffer(file);
+    std::ostream stream(&buffer);
+
+    good = Chic::columnar(stream, dictionary, compress) && stream.flush();
+  }
+
+  return !std::fclose(file) && good;
+}
+
+// Print the row count and the range of every column of every level
+static bool read(const char* path)
+{
+  static const char* const names[] = { "num", "den", "first", "second", "base", "code" };
+  Chic::Columns columns(path);
+
+  if (!columns)
+    return false;
+
+  for (std::size_t level = 0; level < columns.levels(); ++level) {
+    for (int column = 0; column < 6; ++column) {
+      std::uint64_t minimum = -1;
+      std::uint64_t maximum = 0;
+      std::uint64_t rows = 0;
+
+      columns.scan(level, Chic::Column(column), [&](std::uint64_t value) {
+        minimum = (std::min)(minimum, value);
+        maximum = (std::max)(maximum, value);
+        ++rows;
+      });
+
+      if (rows)
+        std::cout << "{\"digit\":" << columns.digit() << ",\"level\":" << level + 1 << ",\"column\":\"" << names[column]
+          << "\",\"rows\":" << rows << ",\"min\":" << minimum << ",\"max\":" << maximum << "}\n";
+    }
+  }
+
+  return true;
+}
+
+static int usage(const char* program)
+{
+  std::cout << "Usage: " << program << " [-c] [-q] DIGIT DEPTH OUTPUT\n"
+    "       " << program << " -r INPUT\n\n"
+    "-c      Pack each block to the width of its values\n"
+    "-q      Export the rational dictionary instead of the integral one\n"
+    "-r      Scan every column of an export and print its range as JSON\n"
+    "DIGIT   The digit of the dictionary\n"
+    "DEPTH   The levels to grow and export\n"
+    "OUTPUT  The columnar file to write\n";
+
+  return 2;
+}
+
+int main(int argc, char** argv)
+{
+  std::ios_base::sync_with_stdio(false);
+
+  bool compress = false;
+  bool rational = false;
+  int index = 1;
+
+  if (argc == 3 && argv[1] == std::string("-r"))
+    return !read(argv[2]);
+
+  for (; index < argc && argv[index][0] == '-'; ++index) {
+    if (argv[index] == std::string("-c"))
+      compress = true;
+    else if (argv[index] == std::string("-q"))
+      rational = true;
+    else
+      return usage(*argv);
+  }
+
+  if (index + 3 != argc)
+    return usage(*argv);
+
+  int digit = 0;
+  std::size_t depth = 0;
+
+  std::istringstream(argv[index]) >> digit;
+  std::istringstream(argv[index + 1]) >> depth;
+
+  if (digit < 1 || digit > 9 || !depth)
+    return usage(*argv);
+
+  if (rational)
+    return !write<Chic::Fraction<std::uint64_t>>(argv[index + 2], digit, depth, compress);
+
+  return !write<Chic::Entry<std::uint64_t>>(argv[index + 2], digit, depth, compress);
+}
@@ -0,0 +1,247 @@
+#include "chic.h"
+#include "Dictionary.hpp"
+#include "Entry.hpp"
+#include "Fraction.hpp"
+#include "Render.hpp"
+#include "Ring.hpp"
+#include "Step.hpp"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <shared_mutex>
+#include <streambuf>
+#include <cstdint>
+#include <cstring>
+
+// Stream buffer over a block of the caller.  Output beyond the block is
+// counted and dropped, so the caller learns the size to retry with.
+class Span : public std::streambuf
+{
+  private:
+    std::size_t _dropped;
+
+  protected:
+    int_type overflow(int_type) override;
+    std::streamsize xsputn(const char*, std::streamsize) override;
+
+  public:
+    Span(char*, std::size_t);
+
+    std::size_t size() const;
+    void terminate();
+};
+
+Span::Span(char* buffer, std::size_t size)
+  : _dropped(0)
+{
+  setp(buffer, buffer + size);
+}
+
+Span::int_type Span::overflow(int_type character)
+{
+  _dropped += !traits_type::eq_int_type(character, traits_type::eof());
+  return traits_type::not_eof(character);
+}
+
+std::streamsize Span::xsputn(const char* data, std::streamsize size)
+{
+  std::streamsize room = (std::min)(size, std::streamsize(epptr() - pptr()));
+
+  std::memcpy(pptr(), data, room);
+  pbump(room);
+  _dropped += size - room;
+  return size;
+}
+
+std::size_t Span::size() const
+{
+  return pptr() - pbase() + _dropped;
+}
+
+// Write a null character past the end, which the caller must leave room for
+void Span::terminate()
+{
+  *pptr() = '\0';
+}
+
+// Growth is not exception safe: a failed allocation may leave a key in the
+// graph but not in its level, and the cursor of the sweep behind.  So any
+// exception escaping a call poisons the dictionary rather than crossing the C
+// interface, and a poisoned dictionary is never trusted again.
+struct chic_dictionary
+{
+  virtual ~chic_dictionary() {}
+
+  virtual void poison() const noexcept = 0;
+  virtual int grow(std::size_t) = 0;
+  virtual std::size_t level() const = 0;
+  virtual void digits(const std::uint64_t*, std::size_t, std::size_t*) const = 0;
+  virtual std::size_t breakdown(std::uint64_t, Chic::Format, Span&) const = 0;
+};
+
+template<typename Key>
+class Resident : public chic_dictionary
+{
+  private:
+    Chic::Dictionary<Key> _dictionary;
+    mutable std::shared_timed_mutex _mutex;
+    mutable std::atomic<bool> _poisoned;
+
+  public:
+    explicit Resident(int);
+
+    void poison() const noexcept override;
+    int grow(std::size_t) override;
+    std::size_t level() const override;
+    void digits(const std::uint64_t*, std::size_t, std::size_t*) const override;
+    std::size_t breakdown(std::uint64_t, Chic::Format, Span&) const override;
+};
+
+template<typename Key>
+Resident<Key>::Resident(int digit)
+  : _dictionary(digit),
+    _poisoned(false)
+{
+  _dictionary.dense(1 << 20);
+}
+
+// Poisoning takes no lock, since it may follow a failure to take one
+template<typename Key>
+void Resident<Key>::poison() const noexcept
+{
+  _poisoned = true;
+}
+
+template<typename Key>
+int Resident<Key>::grow(std::size_t levels)
+{
+  std::unique_lock<std::shared_timed_mutex> lock(_mutex);
+
+  if (_poisoned)
+    return -1;
+
+  for (; levels; --levels)
+    _dictionary.grow();
+
+  return _dictionary.level();
+}
+
+template<typename Key>
+std::size_t Resident<Key>::level() const
+{
+  std::shared_lock<std::shared_timed_mutex> lock(_mutex);
+  return _poisoned ? 0 : _dictionary.level() - _dictionary.growing();
+}
+
+template<typename Key>
+void Resident<Key>::digits(const std::uint64_t* targets, std::size_t count, std::size_t* digits) const
+{
+  std::shared_lock<std::shared_timed_mutex> lock(_mutex);
+
+  for (std::size_t k = 0; k < count; ++k)
+    digits[k] = _poisoned ? 0 : _dictionary.digits(Key(targets[k]));
+}
+
+template<typename Key>
+std::size_t Resident<Key>::breakdown(std::uint64_t integer, Chic::Format format, Span& span) const
+{
+  std::shared_lock<std::shared_timed_mutex> lock(_mutex);
+  std::ostream stream(&span);
+  Chic::Render<Key> render(stream, format);
+  Key target(integer);
+  std::size_t digits = _poisoned ? 0 : _dictionary.digits(target);
+
+  if (!digits)
+    return 0;
+
+  render.begin(target, _dictionary.digit, digits);
+  _dictionary.template bfs<Chic::Ring<Key>>(target, std::ref(render));
+  render.end();
+  return digits;
+}
+
+int chic_version(void)
+{
+  return CHIC_VERSION;
+}
+
+chic_dictionary* chic_create(int digit, int domain)
+{
+  if (digit < 1 || digit > 9)
+    return nullptr;
+
+  try {
+    switch (domain) {
+      case CHIC_INTEGER:
+        return new Resident<Chic::Entry<std::uint64_t>>(digit);
+      case CHIC_RATIONAL:
+        return new Resident<Chic::Fraction<std::uint64_t>>(digit);
+    }
+  }
+  catch (...) {}
+
+  return nullptr;
+}
+
+void chic_destroy(chic_dictionary* dictionary)
+{
+  delete dictionary;
+}
+
+int chic_grow(chic_dictionary* dictionary, size_t levels)
+{
+  try {
+    return dictionary->grow(levels);
+  }
+  catch (...) {
+    dictionary->poison();
+    return -1;
+  }
+}
+
+size_t chic_level(const chic_dictionary* dictionary)
+{
+  try {
+    return dictionary->level();
+  }
+  catch (...) {
+    dictionary->poison();
+    return 0;
+  }
+}
+
+void chic_digits(const chic_dictionary* dictionary, const uint64_t* targets, size_t count, size_t* digits)
+{
+  try {
+    dictionary->digits(targets, count, digits);
+  }
+  catch (...) {
+    dictionary->poison();
+    std::fill(digits, digits + count, 0);
+  }
+}
+
+size_t chic_breakdown(const chic_dictionary* dictionary, uint64_t target, int format, char* buffer, size_t size)
+{
+  static const Chic::Format formats[] = { Chic::Format::text, Chic::Format::json, Chic::Format::binary };
+
+  bool text = format != CHIC_BINARY;
+  Span span(buffer, size - (text && size));
+
+  try {
+    if (format < CHIC_TEXT || format > CHIC_BINARY || !dictionary->breakdown(target, formats[format], span))
+      return 0;
+  }
+  catch (...) {
+    dictionary->poison();
+    return 0;
+  }
+
+  if (text && size)
+    span.terminate();
+
+  return span.size();
+}
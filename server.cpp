@@ -0,0 +1,356 @@
+#include "Breakdown.hpp"
+#include "Cache.hpp"
+#include "Dictionary.hpp"
+#include "Entry.hpp"
+#include "Fraction.hpp"
+#include "Step.hpp"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <cstdint>
+#include <cstdio>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+typedef std::uint_fast64_t Unsigned;
+
+template<typename Key>
+class Resident
+{
+  private:
+    Chic::Dictionary<Key> _dictionary;
+    mutable std::shared_timed_mutex _mutex;
+
+    std::size_t _render(std::ostream&, Key, std::size_t) const;
+
+  public:
+    Resident(int, std::uintmax_t dense, std::size_t memory);
+
+    std::size_t level() const;
+    bool grow(std::size_t budget);
+    std::size_t solve(std::ostream&, Key, std::size_t limit);
+};
+
+template<typename Key>
+Resident<Key>::Resident(int digit, std::uintmax_t dense, std::size_t memory)
+  : _dictionary(digit)
+{
+  _dictionary.dense(dense);
+  _dictionary.cap(memory);
+}
+
+template<typename Key>
+std::size_t Resident<Key>::_render(std::ostream& stream, Key target, std::size_t limit) const
+{
+  std::size_t digits = _dictionary.digits(target);
+
+  if (digits > limit)
+    return 0;
+
+  if (digits) {
+    stream << target << '#' << _dictionary.digit << (std::is_same<Key, Chic::Entry<Unsigned>>::value ? " in Z: " : " in Q: ")
+      << digits << " digits\n--------------------\n";
+    _dictionary.bfs(target, Chic::breakdown<Key>(stream));
+    stream << '\n';
+  }
+
+  return digits;
+}
+
+template<typename Key>
+std::size_t Resident<Key>::level() const
+{
+  std::shared_lock<std::shared_timed_mutex> lock(_mutex);
+  return _dictionary.level() - _dictionary.growing();
+}
+
+// Grow by a slice unless opening the next level would exceed the memory cap
+template<typename Key>
+bool Resident<Key>::grow(std::size_t budget)
+{
+  std::unique_lock<std::shared_timed_mutex> lock(_mutex);
+
+  if (!_dictionary.growing() && _dictionary.bytes(_dictionary.predict()) > _dictionary.memory())
+    return false;
+
+  _dictionary.grow_some(budget);
+  return true;
+}
+
+// Render the target if it takes at most `limit` digits, growing the
+// dictionary as far as the limit and the memory cap allow.  Return 0 if the
+// target is not found within them.
+template<typename Key>
+std::size_t Resident<Key>::solve(std::ostream& stream, Key target, std::size_t limit)
+{
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(_mutex);
+
+    if (std::size_t digits = _render(stream, target, limit))
+      return digits;
+
+    if (_dictionary.level() - _dictionary.growing() >= limit || _dictionary.full())
+      return 0;
+  }
+
+  {
+    std::unique_lock<std::shared_timed_mutex> lock(_mutex);
+    _dictionary.build(target, limit);
+  }
+
+  std::shared_lock<std::shared_timed_mutex> lock(_mutex);
+  return _render(stream, target, limit);
+}
+
+class Server
+{
+  private:
+    std::deque<Resident<Chic::Entry<Unsigned>>> _integral;
+    std::deque<Resident<Chic::Fraction<Unsigned>>> _rational;
+
+    Chic::Cache<Unsigned, std::string> _cache;
+    std::mutex _mutex;
+
+    std::size_t _warm;
+    std::size_t _depth;
+    std::atomic<bool> _running;
+    std::thread _grower;
+
+    std::uint_fast64_t _requests;
+    std::uint_fast64_t _hits;
+    std::chrono::microseconds _total;
+    std::chrono::microseconds _worst;
+
+    void _grow();
+    std::string _solve(Unsigned);
+
+  public:
+    Server(std::size_t warm, std::size_t depth, std::size_t capacity, std::uintmax_t dense, std::size_t memory);
+    ~Server();
+
+    std::string respond(const std::string&);
+};
+
+Server::Server(std::size_t warm, std::size_t depth, std::size_t capacity, std::uintmax_t dense, std::size_t memory)
+  : _cache(capacity),
+    _warm(warm),
+    _depth(depth),
+    _running(true),
+    _requests(0),
+    _hits(0),
+    _total(0),
+    _worst(0)
+{
+  for (int digit = 1; digit <= 9; ++digit) {
+    _integral.emplace_back(digit, dense, memory);
+    _rational.emplace_back(digit, dense, memory);
+  }
+
+  _grower = std::thread(&Server::_grow, this);
+}
+
+Server::~Server()
+{
+  _running = false;
+  _grower.join();
+}
+
+void Server::_grow()
+{
+  const std::size_t slice = 1 << 16;
+
+  while (_running) {
+    bool idle = true;
+
+    for (int k = 0; _running && k < 9; ++k) {
+      if (_integral[k].level() < _warm && _integral[k].grow(slice))
+        idle = false;
+
+      if (_running && _rational[k].level() < _warm && _rational[k].grow(slice))
+        idle = false;
+    }
+
+    if (idle)
+      return;
+  }
+}
+
+std::string Server::_solve(Unsigned target)
+{
+  std::ostringstream stream;
+
+  for (int k = 0; k < 9; ++k) {
+    std::size_t digits = _integral[k].solve(stream, target, _depth);
+
+    if (!digits)
+      stream << target << '#' << k + 1 << " in Z: unknown\n\n";
+
+    _rational[k].solve(stream, target, digits ? digits - 1 : _depth);
+  }
+
+  return stream.str();
+}
+
+std::string Server::respond(const std::string& line)
+{
+  std::istringstream input(line);
+  std::ostringstream output;
+  Unsigned target;
+
+  if (line == "stats") {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    output << "requests " << _requests << "\nhits " << _hits
+      << "\nmean " << (_requests ? _total.count() / _requests : 0) << " us\nworst " << _worst.count() << " us\n";
+
+    for (int k = 0; k < 9; ++k)
+      output << "levels " << k + 1 << ' ' << _integral[k].level() << ' ' << _rational[k].level() << '\n';
+
+    return output.str() += ".\n";
+  }
+
+  if (!(input >> target) || !target)
+    return "error\n.\n";
+
+  auto start = std::chrono::steady_clock::now();
+  std::string text;
+  bool hit = false;
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (const std::string* cached = _cache.find(target)) {
+      text = *cached;
+      hit = true;
+    }
+  }
+
+  if (!hit)
+    text = _solve(target);
+
+  auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!hit)
+      _cache.insert(target, text);
+
+    ++_requests;
+    _hits += hit;
+    _total += latency;
+    _worst = (std::max)(_worst, latency);
+  }
+
+  std::clog << target << ' ' << latency.count() << " us" << (hit ? " cached\n" : "\n");
+  return text += ".\n";
+}
+
+static void serve(Server& server, int descriptor)
+{
+  std::string buffer;
+  char chunk[4096];
+
+  for (ssize_t size; (size = read(descriptor, chunk, sizeof(chunk))) > 0; ) {
+    buffer.append(chunk, size);
+
+    for (std::size_t end; (end = buffer.find('\n')) != std::string::npos; buffer.erase(0, end + 1)) {
+      std::string response = server.respond(buffer.substr(0, end));
+
+      for (std::size_t done = 0; done < response.size(); ) {
+        ssize_t written = write(descriptor, response.data() + done, response.size() - done);
+
+        if (written <= 0)
+          goto closed;
+
+        done += written;
+      }
+    }
+  }
+
+  closed:
+  close(descriptor);
+}
+
+static int host(Server& server, const char* path)
+{
+  int descriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un address = {};
+
+  address.sun_family = AF_UNIX;
+  std::snprintf(address.sun_path, sizeof(address.sun_path), "%s", path);
+  unlink(path);
+
+  if (descriptor < 0 || bind(descriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) || listen(descriptor, SOMAXCONN)) {
+    std::perror(path);
+    return 1;
+  }
+
+  for (int client; (client = accept(descriptor, nullptr, nullptr)) >= 0; )
+    std::thread(serve, std::ref(server), client).detach();
+
+  std::perror(path);
+  return 1;
+}
+
+static int usage(const char* program)
+{
+  std::cout << "Usage: " << program << " [-w LEVELS] [-d DEPTH] [-c ENTRIES] [-n BOUND] [-m BYTES] [SOCKET]\n\n"
+    "-w LEVELS   Levels to grow in the background (default: 6)\n"
+    "-d DEPTH    Answer unknown for targets taking more digits (default: 8)\n"
+    "-c ENTRIES  Rendered answers to cache (default: 1024)\n"
+    "-n BOUND    Index integers below BOUND directly (default: 1048576)\n"
+    "-m BYTES    Stop growing a dictionary that would exceed this size\n"
+    "SOCKET      Listen on this Unix domain socket instead of stdin\n"
+    "\n"
+    "Each request is a line with a target or \"stats\".\n"
+    "Each response ends with a line with a single dot.\n";
+
+  return 1;
+}
+
+int main(int argc, char** argv)
+{
+  std::ios_base::sync_with_stdio(false);
+
+  std::size_t warm = 6;
+  std::size_t depth = 8;
+  std::size_t capacity = 1024;
+  std::uintmax_t dense = 1 << 20;
+  std::size_t memory = -1;
+  int index = 1;
+
+  for (; index < argc && argv[index][0] == '-'; ++index) {
+    if (argv[index] == std::string("-w") && index + 1 < argc)
+      std::istringstream(argv[++index]) >> warm;
+    else if (argv[index] == std::string("-d") && index + 1 < argc)
+      std::istringstream(argv[++index]) >> depth;
+    else if (argv[index] == std::string("-c") && index + 1 < argc)
+      std::istringstream(argv[++index]) >> capacity;
+    else if (argv[index] == std::string("-n") && index + 1 < argc)
+      std::istringstream(argv[++index]) >> dense;
+    else if (argv[index] == std::string("-m") && index + 1 < argc)
+      std::istringstream(argv[++index]) >> memory;
+    else
+      return usage(*argv);
+  }
+
+  if (index + 1 < argc)
+    return usage(*argv);
+
+  Server server(warm, depth, capacity, dense, memory);
+
+  if (index < argc)
+    return host(server, argv[index]);
+
+  for (std::string line; std::getline(std::cin, line); )
+    std::cout << server.respond(line) << std::flush;
+}
@@ -0,0 +1,139 @@
+#include "Dictionary.hpp"
+#include "Entry.hpp"
+#include "Fraction.hpp"
+#include "Render.hpp"
+#include "Ring.hpp"
+#include "Step.hpp"
+#include "Table.hpp"
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+
+template<typename Unsigned>
+static Unsigned integer(Chic::Entry<Unsigned> key)
+{
+  return key;
+}
+
+template<typename Unsigned>
+static Unsigned integer(Chic::Fraction<Unsigned> key)
+{
+  return (key.den() == 1) * key.num();
+}
+
+// Fill the cells of a digit and key type.  Breakdowns are appended to the
+// blob and their end offsets to `offsets`, whose first entry is 0.
+template<typename Key, typename Unsigned>
+static bool generate(std::vector<std::uint32_t>& cells, std::vector<std::uint64_t>& offsets, std::ostream& blob,
+  Unsigned bound, std::size_t depth, int digit)
+{
+  const bool rational = std::is_same<Key, Chic::Fraction<Unsigned>>::value;
+  Chic::Dictionary<Key> dictionary(digit);
+  Chic::Render<Key> render(blob);
+
+  for (std::size_t level = 0; level < depth; ++level) {
+    dictionary.grow();
+
+    for (Key key: dictionary[level]) {
+      Unsigned target = integer(key);
+
+      if (!target || target > bound)
+        continue;
+
+      std::uint32_t& cell = cells[Chic::Table::index(target, digit, rational)];
+      std::uint32_t integral = cells[Chic::Table::index(target, digit, false)] & 31;
+      std::uint64_t breakdown = 0;
+
+      if (!rational || !integral || level + 1 < integral) {
+        if (offsets.size() >= Chic::Table::limit)
+          return false;
+
+        render.clear();
+        dictionary.template bfs<Chic::Ring<Key>>(key, std::ref(render));
+        breakdown = offsets.size();
+        offsets.push_back(blob.tellp());
+      }
+
+      cell = Chic::Table::cell(level + 1, breakdown);
+    }
+  }
+
+  return true;
+}
+
+// Write the table to a temporary file beside `path` and rename it into place
+// once complete, so a failure leaves an existing table intact.  Breakdowns are
+// streamed to another scratch file, as they follow the cells and offsets in
+// the table but are only known along with them.
+template<typename Unsigned>
+static bool generate(const char* path, Unsigned bound, std::size_t depth)
+{
+  if (depth > 31)
+    return false;
+
+  const std::string temporary = std::string(path) + ".tmp";
+  const std::string scratch = std::string(path) + ".blob";
+
+  std::fstream blob(scratch, std::ios_base::binary | std::ios_base::in | std::ios_base::out | std::ios_base::trunc);
+  std::vector<std::uint32_t> cells(Chic::Table::index(bound + 1, 1, false));
+  std::vector<std::uint64_t> offsets(1);
+  bool good = blob.good();
+
+  for (int digit = 1; good && digit <= 9; ++digit) {
+    good = generate<Chic::Entry<Unsigned>>(cells, offsets, blob, bound, depth, digit)
+      && generate<Chic::Fraction<Unsigned>>(cells, offsets, blob, bound, depth, digit)
+      && blob.good();
+
+    std::clog << "Digit " << digit << (good ? " done\n" : " failed\n");
+  }
+
+  if (good) {
+    Chic::Table::Header header = { { 'C', 'H', 'I', 'C', 'T', 'A', 'B', '2' }, bound, offsets.size() - 1 };
+    std::ofstream file(temporary, std::ios_base::binary | std::ios_base::trunc);
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(cells.data()), cells.size() * sizeof(std::uint32_t));
+    file.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(std::uint64_t));
+
+    if (offsets.back()) {
+      blob.seekg(0);
+      file << blob.rdbuf();
+    }
+
+    file.close();
+    good = file.good() && !std::rename(temporary.c_str(), path);
+  }
+
+  blob.close();
+  std::remove(scratch.c_str());
+
+  if (!good)
+    std::remove(temporary.c_str());
+
+  return good;
+}
+
+int main(int argc, char** argv)
+{
+  std::ios_base::sync_with_stdio(false);
+
+  if (argc == 4) {
+    std::uint_fast64_t bound;
+    std::size_t depth;
+
+    std::istringstream(argv[1]) >> bound;
+    std::istringstream(argv[2]) >> depth;
+
+    return !generate(argv[3], bound, depth);
+  }
+  else {
+    std::cout << "Usage: " << argv[0] << " BOUND DEPTH OUTPUT\n\n"
+      "BOUND   The largest target in the table\n"
+      "DEPTH   The most digits to search for each target\n"
+      "OUTPUT  The table file to write\n";
+  }
+}
@@ -1,8 +1,20 @@
+#include "Columnar.hpp"
+#include "Dictionary.hpp"
+#include "Entry.hpp"
+#include "Filter.hpp"
 #include "Fraction.hpp"
+#include "Step.hpp"
+#include <fstream>
 #include <random>
+#include <sstream>
+#include <string>
+#include <vector>
 #include <cassert>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
 
-int main()
+static void arithmetic()
 {
   typedef Chic::Fraction<std::uint_fast64_t> Fraction;
 
@@ -13,9 +25,208 @@ int main()
 
   Fraction sum = x + y;
   Fraction product = x * y;
-  Fraction square = Fraction(x).apply(x);
+  Fraction square = x.square();
 
   assert(!std::isfinite(sum) || sum - x == y);
   assert(!(y && std::isfinite(product)) || product / y == x);
   assert(!std::isfinite(square) || square.sqrt() == x);
+
+  // Sums and differences are reduced, so equal values are equal keys
+  assert(Fraction(1, 2) + Fraction(1, 2) == Fraction(1));
+  assert(Fraction(5, 6) - Fraction(1, 3) == Fraction(1, 2));
+  assert(std::hash<Fraction>()(Fraction(1, 6) + Fraction(1, 3)) == std::hash<Fraction>()(Fraction(1, 2)));
+}
+
+// Every key of a dictionary passes a filter made of it, and lookups through
+// the filters of frozen levels find every key.
+template<typename Key>
+static void filter(int digit, std::size_t depth)
+{
+  Chic::Dictionary<Key> dictionary(digit);
+
+  for (std::size_t level = 0; level < depth; ++level)
+    dictionary.grow();
+
+  for (std::size_t level = 0; level < depth; ++level) {
+    Chic::Filter<Key> filter(dictionary[level].size());
+
+    for (Key key: dictionary[level])
+      filter.insert(key);
+
+    for (Key key: dictionary[level]) {
+      assert(filter.contains(key));
+      assert(dictionary.contains(key));
+      assert(dictionary.reachable(key, level + 1));
+    }
+  }
+}
+
+// Growing by slices of pairs, which pause and resume within a length and
+// within the sumset of a length, gives the levels of growing at once.
+template<typename Key>
+static void resume(int digit, std::size_t depth, std::size_t budget)
+{
+  Chic::Dictionary<Key> whole(digit);
+  Chic::Dictionary<Key> sliced(digit);
+
+  for (std::size_t level = 0; level < depth; ++level) {
+    whole.grow();
+
+    while (!sliced.grow_some(budget)) {
+      assert(sliced.growing());
+      assert(sliced.level() == level + 1);
+      assert(sliced.progress() <= 1);
+    }
+
+    assert(!sliced.growing());
+    assert(sliced[level] == whole[level]);
+    assert(sliced.bytes() == whole.bytes());
+  }
+}
+
+// Building up to the current level finishes a level left partial by
+// grow_some(), whose keys then take exactly as many digits as the limit.
+template<typename Key>
+static void partial(int digit, std::size_t depth, std::size_t budget)
+{
+  Chic::Dictionary<Key> whole(digit);
+
+  for (std::size_t level = 0; level < depth; ++level)
+    whole.grow();
+
+  for (Key key: whole[depth - 1]) {
+    Chic::Dictionary<Key> sliced(digit);
+
+    for (std::size_t level = 1; level < depth; ++level)
+      sliced.grow();
+
+    sliced.grow_some(budget);
+
+    if (!sliced.growing() || sliced.contains(key))
+      continue;
+
+    std::size_t limit = sliced.level();
+
+    assert(!sliced.build(key, limit));
+    assert(sliced.digits(key) == depth);
+    assert(sliced.build(key, limit + 1));
+  }
+}
+
+// Reading back a columnar dump gives the keys and steps of every level
+template<typename Key>
+static void columnar(int digit, std::size_t depth, bool compress)
+{
+  const char* path = "test.chic";
+  Chic::Dictionary<Key> dictionary(digit);
+
+  for (std::size_t level = 0; level < depth; ++level)
+    dictionary.grow();
+
+  {
+    std::ofstream stream(path, std::ios_base::binary | std::ios_base::trunc);
+    bool good = Chic::columnar(stream, dictionary, compress);
+
+    assert(good);
+  }
+
+  Chic::Columns columns(path);
+  std::vector<Key> rows(1);
+
+  assert(columns);
+  assert(columns.digit() == digit);
+  assert(columns.rational() == Chic::detail::rational(Key()));
+  assert(columns.levels() == depth);
+
+  for (std::size_t level = 0; level < depth; ++level) {
+    const auto& keys = dictionary[level];
+    std::vector<std::uint64_t> values[Chic::Columns::columns];
+
+    assert(columns.size(level) == keys.size());
+
+    for (std::size_t column = 0; column < Chic::Columns::columns; ++column)
+      columns.scan(level, Chic::Column(column), [&](std::uint64_t value) { values[column].push_back(value); });
+
+    rows.insert(rows.end(), keys.begin(), keys.end());
+
+    for (std::size_t k = 0; k < keys.size(); ++k) {
+      Chic::Step<Key> step = dictionary.step(keys[k]);
+
+      assert(values[int(Chic::Column::num)][k] == Chic::detail::num(keys[k]));
+      assert(!columns.rational() || values[int(Chic::Column::den)][k] == Chic::detail::den(keys[k]));
+      assert(values[int(Chic::Column::base)][k] == std::uint8_t(step.note().base()));
+      assert(values[int(Chic::Column::code)][k] == std::uint8_t(step.note().code()));
+      assert(!step.note().base() || rows.at(values[int(Chic::Column::first)][k]) == step.first());
+      assert(!step.second() || rows.at(values[int(Chic::Column::second)][k]) == step.second());
+    }
+  }
+
+  std::remove(path);
+}
+
+// A dump whose trailer is intact but whose body is truncated, or whose
+// extents or block headers point past the directory, is rejected on opening.
+template<typename Key>
+static void corrupt(int digit, std::size_t depth)
+{
+  typedef Chic::Columns Columns;
+
+  const char* path = "test.chic";
+  Chic::Dictionary<Key> dictionary(digit);
+  std::string bytes;
+
+  for (std::size_t level = 0; level < depth; ++level)
+    dictionary.grow();
+
+  {
+    std::ostringstream stream;
+    bool good = Chic::columnar(stream, dictionary);
+
+    assert(good);
+    bytes = stream.str();
+  }
+
+  Columns::Trailer trailer;
+  std::memcpy(&trailer, bytes.data() + bytes.size() - sizeof(trailer), sizeof(trailer));
+
+  auto rejected = [&](const std::string& variant) {
+    std::ofstream(path, std::ios_base::binary | std::ios_base::trunc) << variant;
+    return !Columns(path);
+  };
+
+  std::string truncated = bytes.substr(0, trailer.directory / 2) + bytes.substr(bytes.size() - sizeof(trailer));
+  std::string extent = bytes;
+  std::string block = bytes;
+  std::uint64_t offset;
+
+  std::memcpy(&offset, bytes.data() + trailer.directory, sizeof(offset));
+  std::memcpy(&extent[trailer.directory], &trailer.directory, sizeof(trailer.directory));
+  std::memset(&block[offset + offsetof(Columns::Block, rows)], 0xff, sizeof(Columns::Block::rows));
+
+  assert(!rejected(bytes));
+  assert(rejected(truncated));
+  assert(rejected(extent));
+  assert(rejected(block));
+
+  std::remove(path);
+}
+
+int main()
+{
+  arithmetic();
+
+  filter<Chic::Entry<std::uint64_t>>(3, 5);
+  filter<Chic::Fraction<std::uint64_t>>(3, 5);
+
+  resume<Chic::Entry<std::uint64_t>>(3, 6, 97);
+  resume<Chic::Entry<std::uint64_t>>(9, 5, 1);
+  resume<Chic::Fraction<std::uint64_t>>(3, 5, 1000);
+
+  partial<Chic::Entry<std::uint64_t>>(3, 4, 5);
+
+  columnar<Chic::Entry<std::uint64_t>>(9, 4, false);
+  columnar<Chic::Entry<std::uint64_t>>(9, 4, true);
+  columnar<Chic::Fraction<std::uint64_t>>(3, 4, true);
+
+  corrupt<Chic::Entry<std::uint64_t>>(9, 4);
 }